@@ -0,0 +1,198 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <memory_resource>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "OrderBook.h"
+#include "OrderFlow.h"
+
+// Each benchmark applies one pregenerated command per iteration. When a
+// batch runs out the book is reseeded and the next batch generated with
+// timing paused, so every batch starts from a book of the configured shape.
+// Time per iteration is the cost of one command; items_per_second is the
+// command rate.
+
+static constexpr std::size_t BatchSize = 256;
+
+// Description: Fresh book seeded to config's depth and queue length.
+static std::unique_ptr<Orderbook> SeedBook(OrderFlowGenerator& generator)
+{
+   OrderbookCapacity capacity;
+   capacity.maxOrders = 1 << 16;
+
+   auto book = std::make_unique<Orderbook>(1.0, capacity);
+   for (const EngineCommand& command : generator.SeedBook())
+      (void)ApplyCommand(*book, command);
+
+   book->GetExecutionEvents().Clear();
+   book->GetLevelUpdates().Clear();
+   return book;
+}
+
+// Description: Times next() commands against a book reseeded every batch.
+template <typename NextCommand>
+static void RunFlow(benchmark::State& state, const OrderFlowConfig& config, NextCommand next)
+{
+   std::unique_ptr<Orderbook> book;
+   std::vector<EngineCommand> batch;
+   std::size_t position = 0;
+   std::uint64_t batches = 0;
+
+   for (auto _ : state)
+   {
+      if (position == batch.size())
+      {
+         state.PauseTiming();
+         OrderFlowConfig batchConfig = config;
+         batchConfig.seed = config.seed + batches++;
+
+         OrderFlowGenerator generator(batchConfig);
+         book = SeedBook(generator);
+         // Never more commands than seeded orders, so cancels and modifies
+         // always have a target.
+         const std::size_t batchSize = std::min(BatchSize, generator.GetLiveCount());
+         batch.clear();
+         for (std::size_t i = 0; i < batchSize; ++i)
+            batch.push_back(next(generator));
+         position = 0;
+         state.ResumeTiming();
+      }
+
+      benchmark::DoNotOptimize(ApplyCommand(*book, batch[position++]));
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+
+// Description: Book shape from the benchmark arguments (depth, queue length).
+static OrderFlowConfig ConfigFromArgs(const benchmark::State& state)
+{
+   OrderFlowConfig config;
+   config.bookDepth = static_cast<std::size_t>(state.range(0));
+   config.queueLength = static_cast<std::size_t>(state.range(1));
+   return config;
+}
+
+static void BM_MixedFlow(benchmark::State& state)
+{
+   RunFlow(state, ConfigFromArgs(state), [](OrderFlowGenerator& generator) { return generator.Next(); });
+}
+
+static void BM_NewOrder(benchmark::State& state, const OrderType type)
+{
+   RunFlow(state, ConfigFromArgs(state), [type](OrderFlowGenerator& generator) { return generator.NextNew(type); });
+}
+
+static void BM_RestingLimit(benchmark::State& state)
+{
+   OrderFlowConfig config = ConfigFromArgs(state);
+   config.aggressiveLimitRatio = 0.0;
+   RunFlow(state, config, [](OrderFlowGenerator& generator) { return generator.NextNew(OrderType::GoodTillCancel); });
+}
+
+static void BM_CancelOrder(benchmark::State& state)
+{
+   RunFlow(state, ConfigFromArgs(state), [](OrderFlowGenerator& generator) { return generator.NextCancel(); });
+}
+
+static void BM_ModifyOrder(benchmark::State& state)
+{
+   RunFlow(state, ConfigFromArgs(state), [](OrderFlowGenerator& generator) { return generator.NextModify(); });
+}
+
+// (book depth in levels per side, orders per level)
+static void BookShapes(benchmark::internal::Benchmark* benchmark)
+{
+   benchmark->ArgNames({"depth", "queue"});
+   benchmark->Args({10, 5});
+   benchmark->Args({50, 10});
+   benchmark->Args({200, 20});
+}
+
+// The reference index on its own, at live-order counts the flow
+// benchmarks never reach. IDs are random 64-bit values, as sparse as a
+// client's. Each iteration is what one order costs the index over its
+// life (an insert, a lookup and an erase), with the live count held
+// steady. The node-based map is the one the book used before OrderIndex.
+using NodeIndex = std::pmr::unordered_map<ID, SlotIndex>;
+
+static void IndexInsert(OrderIndex& index, const ID id, const SlotIndex slot) { index.Insert(id, slot); }
+static void IndexInsert(NodeIndex& index, const ID id, const SlotIndex slot) { index.emplace(id, slot); }
+
+static SlotIndex IndexFind(OrderIndex& index, const ID id) { return index.Find(id)->slot; }
+static SlotIndex IndexFind(NodeIndex& index, const ID id) { return index.find(id)->second; }
+
+static void IndexErase(OrderIndex& index, const ID id) { index.Erase(index.Find(id)); }
+static void IndexErase(NodeIndex& index, const ID id) { index.erase(id); }
+
+// Description: Keeps range(0) IDs live in a window that slides over twice
+// as many pregenerated IDs: each step looks up a random live ID, erases
+// the oldest and inserts the next.
+template <typename Index>
+static void RunIndexChurn(benchmark::State& state, Index& index)
+{
+   const std::size_t live = static_cast<std::size_t>(state.range(0));
+   std::mt19937_64 random(42);
+
+   std::vector<ID> ids(live * 2);
+   for (ID& id : ids)
+      id = random();
+
+   std::vector<std::size_t> lookups(1 << 16);
+   for (std::size_t& offset : lookups)
+      offset = random() % live;
+
+   for (std::size_t i = 0; i < live; ++i)
+      IndexInsert(index, ids[i], static_cast<SlotIndex>(i));
+
+   std::size_t oldest = 0;
+   std::size_t step = 0;
+   for (auto _ : state)
+   {
+      benchmark::DoNotOptimize(IndexFind(index, ids[(oldest + lookups[step++ & 0xFFFF]) % ids.size()]));
+      IndexErase(index, ids[oldest]);
+      IndexInsert(index, ids[(oldest + live) % ids.size()], static_cast<SlotIndex>(oldest));
+      oldest = (oldest + 1) % ids.size();
+   }
+   state.SetItemsProcessed(state.iterations());
+}
+
+static void BM_OrderIndexChurn(benchmark::State& state)
+{
+   OrderIndex index(static_cast<std::size_t>(state.range(0)));
+   RunIndexChurn(state, index);
+}
+
+static void BM_NodeIndexChurn(benchmark::State& state)
+{
+   std::pmr::unsynchronized_pool_resource pool;
+   NodeIndex index(&pool);
+   index.reserve(static_cast<std::size_t>(state.range(0)));
+   RunIndexChurn(state, index);
+}
+
+// Live orders; one run each, since filling the index dominates setup.
+static void IndexSizes(benchmark::internal::Benchmark* benchmark)
+{
+   benchmark->ArgName("live");
+   benchmark->Arg(1'000'000);
+   benchmark->Arg(4'000'000);
+   benchmark->Arg(10'000'000);
+   benchmark->Iterations(1 << 22);
+}
+
+BENCHMARK(BM_MixedFlow)->Apply(BookShapes);
+BENCHMARK(BM_RestingLimit)->Apply(BookShapes);
+BENCHMARK_CAPTURE(BM_NewOrder, GoodTillCancel, OrderType::GoodTillCancel)->Apply(BookShapes);
+BENCHMARK_CAPTURE(BM_NewOrder, ImmediateOrCancel, OrderType::ImmediateOrCancel)->Apply(BookShapes);
+BENCHMARK_CAPTURE(BM_NewOrder, FillOrKill, OrderType::FillOrKill)->Apply(BookShapes);
+BENCHMARK_CAPTURE(BM_NewOrder, Market, OrderType::Market)->Apply(BookShapes);
+BENCHMARK(BM_CancelOrder)->Apply(BookShapes);
+BENCHMARK(BM_ModifyOrder)->Apply(BookShapes);
+BENCHMARK(BM_OrderIndexChurn)->Apply(IndexSizes);
+BENCHMARK(BM_NodeIndexChurn)->Apply(IndexSizes);
+
+BENCHMARK_MAIN();
@@ -1,28 +1,145 @@
-#include <algorithm>
+#pragma once
+
 #include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <unordered_map>
+#include <memory_resource>
 
 #include "Order.h"
 
+// Recently finished orders, held in a fixed-size ring with an ID index so
+// Contains / Find are O(1). When the ring is full the oldest entry is
+// evicted: if a segment file is open it is appended there as a compact
+// fixed-width record, otherwise it is dropped. Memory therefore stays flat
+// however long the session runs; older history lives only on disk.
 class CompletedOrders
 {
 public:
+   explicit CompletedOrders(std::size_t capacity = 4096,
+                            std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : m_capacity(capacity == 0 ? 1 : capacity),
+        m_completed(resource),
+        m_index(resource)
+   {
+      m_completed.reserve(m_capacity);
+      m_index.reserve(m_capacity);
+   }
+
+   ~CompletedOrders() { CloseSegment(); }
+
+   CompletedOrders(const CompletedOrders&) = delete;
+   CompletedOrders& operator=(const CompletedOrders&) = delete;
+
    void Add(Order&& order)
    {
-       m_completed.push_back(std::move(order));
+      const ID id = order.GetId();
+
+      if (m_completed.size() < m_capacity)
+      {
+         m_index[id] = m_completed.size();
+         m_completed.push_back(std::move(order));
+         return;
+      }
+
+      Evict(m_completed[m_oldest]);
+      m_completed[m_oldest] = std::move(order);
+      m_index[id] = m_oldest;
+      m_oldest = (m_oldest + 1) % m_capacity;
+   }
+
+   // Only the retained window is indexed; spilled orders are on disk.
+   bool Contains(ID orderId) const { return m_index.find(orderId) != m_index.end(); }
+
+   const Order* Find(ID orderId) const
+   {
+      auto it = m_index.find(orderId);
+      return it == m_index.end() ? nullptr : &m_completed[it->second];
    }
 
-   const std::vector<Order>& GetAll() const { return m_completed; }
+   std::size_t size() const { return m_completed.size(); }
+   std::size_t GetSpilledCount() const { return m_spilled; }
+
+   // Visits the retained orders from oldest to newest.
+   template <typename Visitor>
+   void ForEach(Visitor&& visit) const
+   {
+      for (std::size_t i = 0; i < m_completed.size(); ++i)
+         visit(m_completed[(m_oldest + i) % m_completed.size()]);
+   }
 
-   bool Contains(ID orderId) const
+   // Starts streaming evicted orders to path (appending). Returns false if
+   // the file cannot be opened.
+   bool OpenSegment(const std::string& path)
    {
-      for (const auto& order : m_completed)
+      CloseSegment();
+      m_segment = std::fopen(path.c_str(), "ab");
+      return m_segment != nullptr;
+   }
+
+   void CloseSegment()
+   {
+      if (m_segment)
+      {
+         std::fclose(m_segment);
+         m_segment = nullptr;
+      }
+   }
+
+   // Reads every order spilled to a segment file, oldest first.
+   static std::vector<Order> ReadSegment(const std::string& path)
+   {
+      std::vector<Order> orders;
+      std::FILE* file = std::fopen(path.c_str(), "rb");
+      if (!file)
+         return orders;
+
+      SegmentRecord record;
+      while (std::fread(&record, sizeof(record), 1, file) == 1)
       {
-         if (order.GetId() == orderId)
-            return true;
+         Order order(static_cast<OrderType>(record.type), record.id, record.price,
+                     static_cast<Side>(record.side), record.initialVolume);
+         order.SetRemainingVolume(record.remainingVolume);
+         orders.push_back(std::move(order));
       }
-      return false;
+      std::fclose(file);
+      return orders;
    }
 
 private:
-   std::vector<Order> m_completed;
-};
\ No newline at end of file
+   // On-disk layout of one spilled order.
+   struct SegmentRecord
+   {
+      ID id;
+      Price price;
+      Volume initialVolume;
+      Volume remainingVolume;
+      std::uint8_t side;
+      std::uint8_t type;
+      std::uint8_t padding[6];
+   };
+
+   std::size_t m_capacity;
+   std::pmr::vector<Order> m_completed;
+   std::pmr::unordered_map<ID, std::size_t> m_index;
+   std::size_t m_oldest = 0;
+   std::size_t m_spilled = 0;
+   std::FILE* m_segment = nullptr;
+
+   void Evict(const Order& order)
+   {
+      auto it = m_index.find(order.GetId());
+      if (it != m_index.end() && it->second == m_oldest)
+         m_index.erase(it);
+
+      ++m_spilled;
+      if (!m_segment)
+         return;
+
+      const SegmentRecord record{order.GetId(), order.GetPrice(), order.GetInitialVolume(),
+                                 order.GetRemainingVolume(), static_cast<std::uint8_t>(order.GetSide()),
+                                 static_cast<std::uint8_t>(order.GetType()), {}};
+      std::fwrite(&record, sizeof(record), 1, m_segment);
+   }
+};
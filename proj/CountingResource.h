@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory_resource>
+#include <cstddef>
+
+// Upstream memory resource that forwards to the global heap and counts
+// every allocation it serves. The Orderbook puts this underneath its
+// preallocated arena and node pools, so once the pools are warm the count
+// stays flat; any growth means the hot path went back to malloc.
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+   std::size_t GetAllocationCount() const { return m_allocations; }
+   std::size_t GetBytesAllocated() const { return m_bytes; }
+
+private:
+   std::size_t m_allocations = 0;
+   std::size_t m_bytes = 0;
+
+   void* do_allocate(std::size_t bytes, std::size_t alignment) override
+   {
+      ++m_allocations;
+      m_bytes += bytes;
+      return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+   }
+
+   void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override
+   {
+      std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+   }
+
+   bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+   {
+      return this == &other;
+   }
+};
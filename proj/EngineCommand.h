@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+#include "OrderDetails.h"
+
+class Orderbook;
+
+enum class CommandType : std::uint8_t
+{
+   New,
+   Cancel,
+   Modify,
+   CancelAll,
+   CancelRange,
+   CancelByOwner,
+   AdvanceTime
+};
+
+// Fixed-size request to a book. New uses every field (stopPrice only for
+// Stop and StopLimit); Cancel uses only orderId; Modify uses orderId,
+// price and volume. CancelAll uses side; CancelRange uses side and the
+// inclusive range price..stopPrice; CancelByOwner uses owner. expiry is
+// a GoodTillDate order's expiry, and for AdvanceTime the new time.
+struct EngineCommand
+{
+   CommandType type;
+   OrderType orderType;
+   Side side;
+   ID orderId;
+   Price price;
+   Volume volume;
+   Price stopPrice = 0;
+   OwnerID owner = 0;
+   SelfTradePrevention selfTradePrevention = SelfTradePrevention::None;
+   Timestamp expiry = 0;
+};
+
+// Result of one EngineCommand. outcome is meaningful for New; success is
+// the Cancel/Modify return value, for the mass cancels and AdvanceTime
+// whether anything was cancelled or expired, and for New whether the order was not rejected outright.
+struct EngineResponse
+{
+   CommandType type;
+   OrderOutcome outcome;
+   bool success;
+   ID orderId;
+};
+
+// Runs one command against a book through the matching Orderbook call.
+EngineResponse ApplyCommand(Orderbook& book, const EngineCommand& command);
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "OrderDetails.h"
+
+enum class ExecutionEventType
+{
+   Accepted,     // order passed validation and entered matching
+   Fill,         // resting order fully filled
+   PartialFill,  // resting order partially filled, remainder still rests
+   Cancelled,    // order or its unfilled remainder removed/rejected
+   Modified,     // resting order's price and/or volume changed
+   Triggered,    // stop order released; it is re-accepted as its market or limit order
+   SelfTradePrevented,  // volume removed instead of trading with the same owner
+   Expired,             // GoodTillDate or Day order reached its expiry and left the book
+   Rejected             // command refused untouched: the journal could not record it, or its order ID is live
+};
+
+// One execution report. For fills, orderId is the resting (maker) order and
+// counterpartyId the incoming (taker) order; price is the maker's price and
+// remaining is what the maker still has resting. SelfTradePrevented is
+// reported for each side it shrinks, with counterpartyId the other order,
+// price the resting order's and quantity the volume removed. For every other event
+// orderId is the order concerned and quantity its accepted, cancelled or
+// new volume.
+struct ExecutionEvent
+{
+   ExecutionEventType type;
+   Side side;
+   ID orderId;
+   ID counterpartyId;
+   Price price;
+   Volume quantity;
+   Volume remaining;
+};
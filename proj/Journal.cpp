@@ -0,0 +1,172 @@
+#include "Journal.h"
+#include "OrderBook.h"
+
+#include <cstring>
+
+static constexpr char JournalMagic[8] = {'L', 'O', 'B', 'J', 'R', 'N', 'L', '1'};
+static constexpr std::uint32_t JournalVersion = 4;
+
+// Description: Creates and preallocates a journal file and writes its header.
+bool Journal::Create(const std::string& path, const std::uint64_t recordCapacity,
+                     const JournalSync mode, const std::uint64_t group)
+{
+   Close();
+
+   if (!file.Create(path, sizeof(Header) + recordCapacity * sizeof(JournalRecord)))
+      return false;
+
+   Header header{};
+   std::memcpy(header.magic, JournalMagic, sizeof(JournalMagic));
+   header.version = JournalVersion;
+   header.recordSize = sizeof(JournalRecord);
+   header.capacity = recordCapacity;
+   std::memcpy(file.GetData(), &header, sizeof(header));
+
+   if (!file.Flush(0, sizeof(header)))
+   {
+      Close();
+      return false;
+   }
+   return Attach(mode, group);
+}
+
+// Description: Maps an existing journal and finds the end of its records.
+bool Journal::Open(const std::string& path, const JournalSync mode, const std::uint64_t group)
+{
+   Close();
+
+   if (!file.OpenReadWrite(path))
+      return false;
+
+   return Attach(mode, group);
+}
+
+// Description: Validates the header and counts the committed records.
+bool Journal::Attach(const JournalSync mode, const std::uint64_t group)
+{
+   Header header;
+   if (file.GetSize() < sizeof(Header))
+   {
+      Close();
+      return false;
+   }
+   std::memcpy(&header, file.GetData(), sizeof(header));
+
+   if (std::memcmp(header.magic, JournalMagic, sizeof(JournalMagic)) != 0 ||
+       header.version != JournalVersion || header.recordSize != sizeof(JournalRecord) ||
+       file.GetSize() < sizeof(Header) + header.capacity * sizeof(JournalRecord))
+   {
+      Close();
+      return false;
+   }
+
+   capacity = header.capacity;
+   sync = mode;
+   groupSize = group == 0 ? 1 : group;
+
+   const JournalRecord* records = GetRecords();
+   count = 0;
+   while (count < capacity && records[count].sequence == count + 1)
+      ++count;
+   synced = count;
+
+   return true;
+}
+
+// Description: Copies one command into the next slot and applies the
+// configured sync policy.
+bool Journal::Append(const EngineCommand& command)
+{
+   if (!file.IsOpen() || count == capacity)
+      return false;
+
+   JournalRecord& record = Records()[count];
+   record.orderId = command.orderId;
+   record.price = command.price;
+   record.volume = command.volume;
+   record.stopPrice = command.stopPrice;
+   record.expiry = command.expiry;
+   record.commandType = static_cast<std::uint8_t>(command.type);
+   record.orderType = static_cast<std::uint8_t>(command.orderType);
+   record.side = static_cast<std::uint8_t>(command.side);
+   record.selfTradePrevention = static_cast<std::uint8_t>(command.selfTradePrevention);
+   record.owner = command.owner;
+   // Sequence last: a record only counts once its sequence is in place.
+   record.sequence = ++count;
+
+   if (sync == JournalSync::EveryRecord || (sync == JournalSync::Group && count - synced >= groupSize))
+   {
+      if (!Sync())
+      {
+         record.sequence = 0;
+         --count;
+         return false;
+      }
+   }
+
+   return true;
+}
+
+bool Journal::Sync()
+{
+   if (!file.IsOpen())
+      return false;
+
+   if (count == synced)
+      return true;
+
+   const std::size_t offset = sizeof(Header) + synced * sizeof(JournalRecord);
+   const std::size_t length = (count - synced) * sizeof(JournalRecord);
+
+   if (!file.Flush(offset, length))
+      return false;
+
+   synced = count;
+   return true;
+}
+
+void Journal::Close()
+{
+   if (file.IsOpen())
+      Sync();
+
+   file.Close();
+   capacity = 0;
+   count = 0;
+   synced = 0;
+}
+
+const JournalRecord* Journal::GetRecords() const
+{
+   return reinterpret_cast<const JournalRecord*>(file.GetData() + sizeof(Header));
+}
+
+JournalRecord* Journal::Records()
+{
+   return reinterpret_cast<JournalRecord*>(file.GetData() + sizeof(Header));
+}
+
+EngineCommand Journal::ToCommand(const JournalRecord& record)
+{
+   return {static_cast<CommandType>(record.commandType), static_cast<OrderType>(record.orderType),
+           static_cast<Side>(record.side), record.orderId, record.price, record.volume, record.stopPrice,
+           record.owner, static_cast<SelfTradePrevention>(record.selfTradePrevention), record.expiry};
+}
+
+// Description: Applies the journalled commands from firstRecord onwards to
+// the book in order.
+std::uint64_t ReplayJournal(const std::string& path, Orderbook& book, const std::uint64_t firstRecord)
+{
+   Journal journal;
+
+   if (!journal.Open(path))
+      return 0;
+
+   const JournalRecord* records = journal.GetRecords();
+   const std::uint64_t count = journal.GetRecordCount();
+
+   for (std::uint64_t i = firstRecord; i < count; ++i)
+      (void)ApplyCommand(book, Journal::ToCommand(records[i]));
+
+   return count > firstRecord ? count - firstRecord : 0;
+}
@@ -0,0 +1,103 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <string>
+
+#include "EngineCommand.h"
+#include "MappedFile.h"
+
+enum class JournalSync
+{
+   None,          // leave write-back to the OS; Sync() on demand
+   EveryRecord,   // flush each record before Append returns
+   Group          // flush once per groupSize records (group commit)
+};
+
+// On-disk layout of one journalled command. Sequence numbers start at 1;
+// the preallocated file is zero-filled, so the first slot whose sequence is
+// not the next expected one marks the end of the journal (including a
+// record torn by a crash).
+struct JournalRecord
+{
+   std::uint64_t sequence;
+   std::uint64_t orderId;
+   std::int64_t price;
+   std::int64_t volume;
+   std::int64_t stopPrice;
+   std::uint64_t expiry;
+   std::uint8_t commandType;
+   std::uint8_t orderType;
+   std::uint8_t side;
+   std::uint8_t selfTradePrevention;
+   std::uint32_t owner;
+};
+
+static_assert(sizeof(JournalRecord) == 56, "journal records are fixed width");
+
+// Write-ahead journal of every command given to a book, appended into a
+// preallocated memory-mapped file. Appending is a struct copy into the
+// mapping; durability is chosen with JournalSync. Replay reads records
+// straight out of the mapping with no parsing.
+class Journal
+{
+public:
+   Journal() = default;
+   ~Journal() { Close(); }
+
+   Journal(const Journal&) = delete;
+   Journal& operator=(const Journal&) = delete;
+
+   // Creates a journal with room for capacity records, replacing any file at path.
+   bool Create(const std::string& path, std::uint64_t capacity,
+               JournalSync sync = JournalSync::None, std::uint64_t groupSize = 64);
+
+   // Reopens an existing journal and continues appending after its last record.
+   bool Open(const std::string& path, JournalSync sync = JournalSync::None, std::uint64_t groupSize = 64);
+
+   // Returns false when the journal is not open, is full, or cannot flush
+   // the record its sync mode requires. A record that could not be
+   // flushed is withdrawn, so false always means the command is not in
+   // the journal.
+   bool Append(const EngineCommand& command);
+
+   // Flushes everything appended since the last flush.
+   bool Sync();
+
+   void Close();
+
+   std::uint64_t GetRecordCount() const { return count; }
+   std::uint64_t GetCapacity() const { return capacity; }
+   const JournalRecord* GetRecords() const;
+
+   static EngineCommand ToCommand(const JournalRecord& record);
+
+private:
+   struct Header
+   {
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t recordSize;
+      std::uint64_t capacity;
+      std::uint8_t reserved[40];
+   };
+
+   static_assert(sizeof(Header) == 64, "journal header is one cache line");
+
+   MappedFile file;
+   std::uint64_t capacity = 0;
+   std::uint64_t count = 0;
+   std::uint64_t synced = 0;
+   JournalSync sync = JournalSync::None;
+   std::uint64_t groupSize = 64;
+
+   JournalRecord* Records();
+   bool Attach(JournalSync mode, std::uint64_t group);
+};
+
+// Rebuilds a book by applying the records in the journal at path, in
+// order, starting after the first firstRecord (e.g. the position a snapshot
+// was taken at). Returns the number of records applied.
+std::uint64_t ReplayJournal(const std::string& path, Orderbook& book, std::uint64_t firstRecord = 0);
+
+#endif
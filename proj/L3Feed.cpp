@@ -0,0 +1,115 @@
+#include "L3Feed.h"
+
+#include <algorithm>
+
+// Description: Steps through a buffer of fixed-width messages.
+std::size_t L3ShadowBook::Apply(const char* data, const std::size_t bytes)
+{
+   std::size_t applied = 0;
+
+   for (std::size_t offset = 0; offset + sizeof(L3Message) <= bytes; offset += sizeof(L3Message))
+   {
+      L3Message message;
+      std::memcpy(&message, data + offset, sizeof(message));
+
+      if (!Apply(message))
+         break;
+      ++applied;
+   }
+   return applied;
+}
+
+// Description: Applies one message to the shadow orders and levels.
+bool L3ShadowBook::Apply(const L3Message& message)
+{
+   if (message.sequence != lastSequence + 1)
+      return false;
+
+   const L3MessageType type = static_cast<L3MessageType>(message.type);
+
+   if (type == L3MessageType::Add)
+   {
+      const ShadowOrder order{static_cast<Side>(message.side), message.price, message.quantity};
+      if (!orders.emplace(message.orderId, order).second)
+         return false;
+
+      AddToLevel(order);
+      lastSequence = message.sequence;
+      return true;
+   }
+
+   auto it = orders.find(message.orderId);
+   if (it == orders.end())
+      return false;
+
+   ShadowOrder& order = it->second;
+
+   switch (type)
+   {
+      case L3MessageType::Execute:
+      case L3MessageType::Cancel:
+      {
+         const Volume quantity = std::min(message.quantity, order.quantity);
+         const bool removed = quantity == order.quantity;
+         RemoveFromLevel(order, quantity, removed);
+         order.quantity -= quantity;
+         if (removed)
+            orders.erase(it);
+         break;
+      }
+
+      case L3MessageType::Replace:
+         RemoveFromLevel(order, order.quantity, true);
+         order.price = message.price;
+         order.quantity = message.quantity;
+         AddToLevel(order);
+         break;
+
+      case L3MessageType::Delete:
+         RemoveFromLevel(order, order.quantity, true);
+         orders.erase(it);
+         break;
+
+      default:
+         return false;
+   }
+
+   lastSequence = message.sequence;
+   return true;
+}
+
+Volume L3ShadowBook::GetVolumeAtPrice(const Side side, const Price price) const
+{
+   const auto& levels = (side == Side::Buy) ? bids : asks;
+   auto it = levels.find(price);
+   return it == levels.end() ? 0 : it->second.volume;
+}
+
+std::size_t L3ShadowBook::GetOrderCountAtPrice(const Side side, const Price price) const
+{
+   const auto& levels = (side == Side::Buy) ? bids : asks;
+   auto it = levels.find(price);
+   return it == levels.end() ? 0 : it->second.orderCount;
+}
+
+void L3ShadowBook::AddToLevel(const ShadowOrder& order)
+{
+   ShadowLevel& level = LevelsFor(order.side)[order.price];
+   level.volume += order.quantity;
+   ++level.orderCount;
+}
+
+// Description: Takes quantity off the order's level, and the order itself
+// when it is leaving the level; drops the level once it is empty.
+void L3ShadowBook::RemoveFromLevel(const ShadowOrder& order, const Volume quantity, const bool removeOrder)
+{
+   auto& levels = LevelsFor(order.side);
+   auto it = levels.find(order.price);
+
+   it->second.volume -= quantity;
+   if (removeOrder)
+      --it->second.orderCount;
+
+   if (it->second.orderCount == 0)
+      levels.erase(it);
+}
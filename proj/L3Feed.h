@@ -0,0 +1,152 @@
+#ifndef L3FEED_H
+#define L3FEED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+#include "OrderDetails.h"
+
+enum class L3MessageType : std::uint8_t
+{
+   Add = 'A',       // order rests: price, quantity
+   Execute = 'E',   // resting order traded: price, quantity executed
+   Cancel = 'X',    // resting order reduced in place: quantity cancelled
+   Replace = 'U',   // resting order moved: new price, new quantity, back of queue
+   Delete = 'D'     // resting order removed
+};
+
+// One order-by-order message. Every message type has the same fixed width
+// and field positions, so a consumer parses a buffer by stepping through it
+// 40 bytes at a time. Sequence numbers start at 1 and never skip, except
+// where the encoder had no room; a gap tells the consumer to resync.
+struct L3Message
+{
+   std::uint64_t sequence;
+   std::uint64_t orderId;
+   std::int64_t price;
+   std::int64_t quantity;
+   std::uint8_t type;
+   std::uint8_t side;
+   std::uint8_t padding[6];
+};
+
+static_assert(sizeof(L3Message) == 40, "L3 messages are fixed width");
+
+// Encodes book changes into a buffer owned by the caller. Attach it to a
+// book and the matching paths append a message per change; drain the
+// buffer (GetData / GetBytesWritten) and Rewind it between batches. When
+// the buffer is full further messages are counted as dropped but still
+// take a sequence number.
+class L3Encoder
+{
+public:
+   L3Encoder() = default;
+   L3Encoder(char* buffer, std::size_t capacity) { SetBuffer(buffer, capacity); }
+
+   void SetBuffer(char* buffer, std::size_t capacity)
+   {
+      m_buffer = buffer;
+      m_capacity = capacity;
+      m_written = 0;
+   }
+
+   void Rewind() { m_written = 0; }
+
+   void Add(ID orderId, Side side, Price price, Volume quantity)
+   {
+      Write(L3MessageType::Add, orderId, side, price, quantity);
+   }
+
+   void Execute(ID orderId, Side side, Price price, Volume quantity)
+   {
+      Write(L3MessageType::Execute, orderId, side, price, quantity);
+   }
+
+   void Cancel(ID orderId, Side side, Price price, Volume quantity)
+   {
+      Write(L3MessageType::Cancel, orderId, side, price, quantity);
+   }
+
+   void Replace(ID orderId, Side side, Price price, Volume quantity)
+   {
+      Write(L3MessageType::Replace, orderId, side, price, quantity);
+   }
+
+   void Delete(ID orderId, Side side, Price price)
+   {
+      Write(L3MessageType::Delete, orderId, side, price, 0);
+   }
+
+   const char* GetData() const { return m_buffer; }
+   std::size_t GetBytesWritten() const { return m_written; }
+   std::uint64_t GetSequence() const { return m_sequence; }
+   std::uint64_t GetDroppedCount() const { return m_dropped; }
+
+private:
+   char* m_buffer = nullptr;
+   std::size_t m_capacity = 0;
+   std::size_t m_written = 0;
+   std::uint64_t m_sequence = 0;
+   std::uint64_t m_dropped = 0;
+
+   void Write(const L3MessageType type, const ID orderId, const Side side, const Price price, const Volume quantity)
+   {
+      ++m_sequence;
+
+      if (m_capacity - m_written < sizeof(L3Message))
+      {
+         ++m_dropped;
+         return;
+      }
+
+      const L3Message message{m_sequence, orderId, price, quantity, static_cast<std::uint8_t>(type),
+                              static_cast<std::uint8_t>(side), {}};
+      std::memcpy(m_buffer + m_written, &message, sizeof(message));
+      m_written += sizeof(message);
+   }
+};
+
+// Rebuilds a book from an L3 stream, for checking a feed against the book
+// that produced it. Keeps every live order and per-level aggregates.
+class L3ShadowBook
+{
+public:
+   // Applies the messages in a buffer in order. Stops at the first message
+   // that is out of sequence or refers to an unknown order; returns the
+   // number applied.
+   std::size_t Apply(const char* data, std::size_t bytes);
+   bool Apply(const L3Message& message);
+
+   Volume GetVolumeAtPrice(Side side, Price price) const;
+   std::size_t GetOrderCountAtPrice(Side side, Price price) const;
+   std::size_t GetOrderCount() const { return orders.size(); }
+   std::uint64_t GetLastSequence() const { return lastSequence; }
+
+private:
+   struct ShadowOrder
+   {
+      Side side;
+      Price price;
+      Volume quantity;
+   };
+
+   struct ShadowLevel
+   {
+      Volume volume = 0;
+      std::size_t orderCount = 0;
+   };
+
+   std::unordered_map<ID, ShadowOrder> orders;
+   std::map<Price, ShadowLevel> bids;
+   std::map<Price, ShadowLevel> asks;
+   std::uint64_t lastSequence = 0;
+
+   std::map<Price, ShadowLevel>& LevelsFor(Side side) { return side == Side::Buy ? bids : asks; }
+   void AddToLevel(const ShadowOrder& order);
+   void RemoveFromLevel(const ShadowOrder& order, Volume quantity, bool removeOrder);
+};
+
+#endif
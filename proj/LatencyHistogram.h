@@ -0,0 +1,224 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <iomanip>
+#include <string>
+
+#include "OrderDetails.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define LOB_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define LOB_HAS_TSC 1
+#endif
+
+// Cycle counter for hot-path timing: the TSC where there is one (constant
+// rate on every CPU this engine targets), otherwise steady_clock nanoseconds.
+inline std::uint64_t ReadTsc()
+{
+#ifdef LOB_HAS_TSC
+   return __rdtsc();
+#else
+   return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+// TSC ticks per nanosecond, measured once against steady_clock.
+inline double TscTicksPerNanosecond()
+{
+#ifdef LOB_HAS_TSC
+   static const double ratio = []
+   {
+      using Clock = std::chrono::steady_clock;
+      const Clock::time_point start = Clock::now();
+      const std::uint64_t startTicks = ReadTsc();
+
+      while (Clock::now() - start < std::chrono::milliseconds(10))
+         ;
+
+      const std::uint64_t ticks = ReadTsc() - startTicks;
+      const double nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+      return static_cast<double>(ticks) / nanoseconds;
+   }();
+   return ratio;
+#else
+   return 1.0;
+#endif
+}
+
+// HDR-style histogram: exact below 64, then 32 linear sub-buckets per power
+// of two, so any recorded value is within about 3% of its bucket's bound.
+// Values up to 2^44 ticks (hours) are kept; larger ones go in the top bucket.
+//
+// One thread records (the thread driving the book); any thread may read at
+// the same time. Counters are relaxed atomics written with plain load/store
+// rather than read-modify-write, so recording costs no locked instruction.
+// A reader sees each counter whole, though not all of them at one instant.
+class LatencyHistogram
+{
+public:
+   static constexpr unsigned SubBucketBits = 6;
+   static constexpr std::uint64_t SubBucketHalf = std::uint64_t{1} << (SubBucketBits - 1);
+   static constexpr unsigned MaxValueBits = 44;
+   static constexpr std::size_t BucketCount = (MaxValueBits - SubBucketBits + 2) * SubBucketHalf;
+
+   void Record(const std::uint64_t value)
+   {
+      Bump(m_counts[IndexOf(value)], 1);
+      Bump(m_total, 1);
+      if (value > m_max.load(std::memory_order_relaxed))
+         m_max.store(value, std::memory_order_relaxed);
+   }
+
+   std::uint64_t GetCount() const { return m_total.load(std::memory_order_relaxed); }
+   std::uint64_t GetMax() const { return m_max.load(std::memory_order_relaxed); }
+
+   // Highest value in the bucket holding the given percentile (0-100), or
+   // 0 if nothing has been recorded.
+   std::uint64_t ValueAtPercentile(const double percentile) const
+   {
+      const std::uint64_t total = GetCount();
+      if (total == 0)
+         return 0;
+
+      const double wanted = percentile / 100.0 * static_cast<double>(total);
+      const std::uint64_t target = wanted < 1.0 ? 1 : static_cast<std::uint64_t>(wanted + 0.5);
+      std::uint64_t seen = 0;
+
+      for (std::size_t index = 0; index < BucketCount; ++index)
+      {
+         seen += m_counts[index].load(std::memory_order_relaxed);
+         if (seen >= target)
+            return std::min(UpperBoundOf(index), GetMax());
+      }
+      return GetMax();
+   }
+
+   static std::size_t IndexOf(std::uint64_t value)
+   {
+      if (value < 2 * SubBucketHalf)
+         return static_cast<std::size_t>(value);
+
+      const std::uint64_t limit = (std::uint64_t{1} << MaxValueBits) - 1;
+      if (value > limit)
+         value = limit;
+
+      const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - SubBucketBits;
+      return static_cast<std::size_t>(shift * SubBucketHalf + (value >> shift));
+   }
+
+   static std::uint64_t UpperBoundOf(const std::size_t index)
+   {
+      if (index < 2 * SubBucketHalf)
+         return index;
+
+      const unsigned shift = static_cast<unsigned>(index / SubBucketHalf) - 1;
+      const std::uint64_t subBucket = index - shift * SubBucketHalf;
+      return ((subBucket + 1) << shift) - 1;
+   }
+
+private:
+   std::array<std::atomic<std::uint64_t>, BucketCount> m_counts{};
+   std::atomic<std::uint64_t> m_total{0};
+   std::atomic<std::uint64_t> m_max{0};
+
+   static void Bump(std::atomic<std::uint64_t>& counter, const std::uint64_t by)
+   {
+      counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+   }
+};
+
+// Records the TSC ticks between construction and destruction.
+class ScopedLatency
+{
+public:
+   explicit ScopedLatency(LatencyHistogram& histogram) : m_histogram(histogram), m_start(ReadTsc()) {}
+   ~ScopedLatency() { m_histogram.Record(ReadTsc() - m_start); }
+
+   ScopedLatency(const ScopedLatency&) = delete;
+   ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+   LatencyHistogram& m_histogram;
+   std::uint64_t m_start;
+};
+
+// A book's latency histograms: ExecuteTrade split by order type and
+// outcome, plus CancelOrder and ModifyOrder. Values are TSC ticks;
+// WritePercentiles converts them to nanoseconds.
+struct OrderbookLatency
+{
+   static constexpr std::size_t OrderTypes = 8;
+   static constexpr std::size_t Outcomes = 5;
+
+   std::array<std::array<LatencyHistogram, Outcomes>, OrderTypes> executeTrade;
+   LatencyHistogram cancelOrder;
+   LatencyHistogram modifyOrder;
+
+   LatencyHistogram& ExecuteTrade(const OrderType type, const OrderOutcome outcome)
+   {
+      return executeTrade[static_cast<std::size_t>(type)][static_cast<std::size_t>(outcome)];
+   }
+
+   const LatencyHistogram& ExecuteTrade(const OrderType type, const OrderOutcome outcome) const
+   {
+      return executeTrade[static_cast<std::size_t>(type)][static_cast<std::size_t>(outcome)];
+   }
+
+   // One row per operation that has been recorded: count, p50, p90, p99,
+   // p99.9, p99.99 and max in nanoseconds.
+   void WritePercentiles(std::ostream& out) const
+   {
+      static constexpr const char* typeNames[] = {"GoodTillCancel", "ImmediateOrCancel", "FillOrKill", "Market",
+                                                  "Stop", "StopLimit", "GoodTillDate", "Day"};
+      static constexpr const char* outcomeNames[] = {"FullyFilled", "PartiallyFilledAndCancelled",
+                                                     "PartiallyFilledAndAddedToBook", "Cancelled",
+                                                     "AddedToOrderbook"};
+
+      out << std::left << std::setw(48) << "operation" << std::right << std::setw(12) << "count"
+          << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+          << std::setw(10) << "p99.9" << std::setw(10) << "p99.99" << std::setw(12) << "max" << '\n';
+
+      for (std::size_t type = 0; type < OrderTypes; ++type)
+      {
+         for (std::size_t outcome = 0; outcome < Outcomes; ++outcome)
+         {
+            const std::string name = std::string("ExecuteTrade ") + typeNames[type] + " " + outcomeNames[outcome];
+            WriteRow(out, name.c_str(), executeTrade[type][outcome]);
+         }
+      }
+      WriteRow(out, "CancelOrder", cancelOrder);
+      WriteRow(out, "ModifyOrder", modifyOrder);
+   }
+
+private:
+   static void WriteRow(std::ostream& out, const char* name, const LatencyHistogram& histogram)
+   {
+      if (histogram.GetCount() == 0)
+         return;
+
+      const double ticksPerNs = TscTicksPerNanosecond();
+      auto ns = [ticksPerNs](const std::uint64_t ticks)
+      {
+         return static_cast<std::uint64_t>(static_cast<double>(ticks) / ticksPerNs + 0.5);
+      };
+
+      out << std::left << std::setw(48) << name << std::right << std::setw(12) << histogram.GetCount()
+          << std::setw(10) << ns(histogram.ValueAtPercentile(50.0))
+          << std::setw(10) << ns(histogram.ValueAtPercentile(90.0))
+          << std::setw(10) << ns(histogram.ValueAtPercentile(99.0))
+          << std::setw(10) << ns(histogram.ValueAtPercentile(99.9))
+          << std::setw(10) << ns(histogram.ValueAtPercentile(99.99))
+          << std::setw(12) << ns(histogram.GetMax()) << '\n';
+   }
+};
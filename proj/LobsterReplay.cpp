@@ -0,0 +1,179 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "MappedFile.h"
+#include "MessageReplay.h"
+#include "OrderBook.h"
+
+// Replays a LOBSTER-style message file (CSV, or the binary ReplayMessage
+// format with --binary) through an Orderbook and reports throughput,
+// per-message latency percentiles and the final book.
+//
+//    LobsterReplay <messages> [--binary] [--tick-size 0.0001] [--max-orders N]
+//                  [--depth N] [--write-binary <out>]
+//
+// The file is mapped and read in place. Pages already consumed are
+// released as the replay moves on, so files far larger than memory stream
+// through in bounded space.
+
+namespace
+{
+   constexpr std::size_t ReleaseStride = std::size_t{64} << 20;
+
+   struct Options
+   {
+      std::string path;
+      std::string binaryOut;
+      bool binary = false;
+      double tickSize = 0.0001;
+      std::size_t maxOrders = std::size_t{1} << 18;
+      std::size_t depth = 5;
+   };
+
+   bool ParseOptions(const int argc, char** argv, Options& options)
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         const std::string arg = argv[i];
+         const bool hasValue = i + 1 < argc;
+
+         if (arg == "--binary")
+            options.binary = true;
+         else if (arg == "--tick-size" && hasValue)
+            options.tickSize = std::atof(argv[++i]);
+         else if (arg == "--max-orders" && hasValue)
+            options.maxOrders = std::strtoull(argv[++i], nullptr, 10);
+         else if (arg == "--depth" && hasValue)
+            options.depth = std::strtoull(argv[++i], nullptr, 10);
+         else if (arg == "--write-binary" && hasValue)
+            options.binaryOut = argv[++i];
+         else if (options.path.empty() && arg[0] != '-')
+            options.path = arg;
+         else
+            return false;
+      }
+      return !options.path.empty();
+   }
+
+   void PrintSide(const Orderbook& book, const Side side, const std::size_t depth)
+   {
+      std::printf("  %s\n", side == Side::Buy ? "bids" : "asks");
+      for (const DepthLevel& level : book.GetDepth(side, depth))
+      {
+         std::printf("    %14.4f  %12lld  (%zu orders)\n", book.ToDecimalPrice(level.price),
+                     static_cast<long long>(level.volume), level.orderCount);
+      }
+   }
+
+   // Description: Pulls every message from reader through the replayer,
+   // timing each one and releasing consumed pages as it goes.
+   template <typename Reader>
+   void Replay(Reader& reader, MappedFile& file, MessageReplayer& replayer, Orderbook& book,
+               std::FILE* binaryOut, LatencyHistogram& latency, std::uint64_t (&results)[3])
+   {
+      ReplayMessage message;
+      std::size_t released = 0;
+
+      while (reader.Next(message))
+      {
+         if (binaryOut)
+            std::fwrite(&message, sizeof(message), 1, binaryOut);
+
+         const std::uint64_t start = ReadTsc();
+         const ReplayResult result = replayer.Apply(message);
+         latency.Record(ReadTsc() - start);
+         ++results[static_cast<int>(result)];
+
+         // Reports are not consumed here; keep the rings from lapping.
+         book.GetExecutionEvents().Clear();
+         book.GetLevelUpdates().Clear();
+
+         if (reader.GetOffset() - released >= ReleaseStride)
+         {
+            file.Release(released, reader.GetOffset() - released);
+            released = reader.GetOffset();
+         }
+      }
+   }
+}
+
+int main(int argc, char** argv)
+{
+   Options options;
+   if (!ParseOptions(argc, argv, options))
+   {
+      std::fprintf(stderr, "usage: %s <messages> [--binary] [--tick-size T] [--max-orders N] [--depth N] "
+                           "[--write-binary <out>]\n", argv[0]);
+      return 2;
+   }
+
+   MappedFile file;
+   if (!file.OpenReadOnly(options.path))
+   {
+      std::fprintf(stderr, "cannot map %s\n", options.path.c_str());
+      return 1;
+   }
+   file.AdviseSequential();
+
+   std::FILE* binaryOut = nullptr;
+   if (!options.binaryOut.empty() && !(binaryOut = std::fopen(options.binaryOut.c_str(), "wb")))
+   {
+      std::fprintf(stderr, "cannot open %s\n", options.binaryOut.c_str());
+      return 1;
+   }
+
+   OrderbookCapacity capacity;
+   capacity.maxOrders = options.maxOrders;
+   Orderbook book(options.tickSize, capacity);
+   MessageReplayer replayer(book);
+   auto latency = std::make_unique<LatencyHistogram>();
+   std::uint64_t results[3] = {};
+   std::size_t malformed = 0;
+
+   const char* begin = file.GetData();
+   const char* end = begin + file.GetSize();
+   const auto wallStart = std::chrono::steady_clock::now();
+
+   if (options.binary)
+   {
+      BinaryMessageReader reader(begin, end);
+      Replay(reader, file, replayer, book, binaryOut, *latency, results);
+   }
+   else
+   {
+      LobsterCsvReader reader(begin, end);
+      Replay(reader, file, replayer, book, binaryOut, *latency, results);
+      malformed = reader.GetMalformedCount();
+   }
+
+   const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+   if (binaryOut)
+      std::fclose(binaryOut);
+
+   const std::uint64_t messages = latency->GetCount();
+   std::printf("messages      %llu (applied %llu, skipped %llu, unknown order %llu, malformed %zu)\n",
+               static_cast<unsigned long long>(messages),
+               static_cast<unsigned long long>(results[static_cast<int>(ReplayResult::Applied)]),
+               static_cast<unsigned long long>(results[static_cast<int>(ReplayResult::Skipped)]),
+               static_cast<unsigned long long>(results[static_cast<int>(ReplayResult::UnknownOrder)]), malformed);
+   std::printf("elapsed       %.3f s\n", seconds);
+   std::printf("throughput    %.0f msg/s\n", seconds > 0 ? static_cast<double>(messages) / seconds : 0.0);
+   const double ticksPerNs = TscTicksPerNanosecond();
+   std::printf("latency (ns)  p50 %.0f  p90 %.0f  p99 %.0f  p99.9 %.0f  max %.0f\n",
+               static_cast<double>(latency->ValueAtPercentile(50.0)) / ticksPerNs,
+               static_cast<double>(latency->ValueAtPercentile(90.0)) / ticksPerNs,
+               static_cast<double>(latency->ValueAtPercentile(99.0)) / ticksPerNs,
+               static_cast<double>(latency->ValueAtPercentile(99.9)) / ticksPerNs,
+               static_cast<double>(latency->GetMax()) / ticksPerNs);
+
+   std::printf("final book    last trade %.4f\n", book.ToDecimalPrice(book.GetLastTradePrice()));
+   PrintSide(book, Side::Sell, options.depth);
+   PrintSide(book, Side::Buy, options.depth);
+   return 0;
+}
@@ -0,0 +1,229 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::Create(const std::string& path, const std::size_t size)
+{
+   return Map(path, size, true, true);
+}
+
+bool MappedFile::OpenReadWrite(const std::string& path)
+{
+   return Map(path, 0, false, true);
+}
+
+bool MappedFile::OpenReadOnly(const std::string& path)
+{
+   return Map(path, 0, false, false);
+}
+
+#ifdef _WIN32
+
+// Description: Opens (or creates and sizes) the file and maps all of it.
+bool MappedFile::Map(const std::string& path, std::size_t size, const bool create, const bool writable)
+{
+   Close();
+
+   HANDLE file = CreateFileA(path.c_str(), writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+                             FILE_SHARE_READ, nullptr, create ? CREATE_ALWAYS : OPEN_EXISTING,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+   if (file == INVALID_HANDLE_VALUE)
+      return false;
+
+   if (create)
+   {
+      LARGE_INTEGER length;
+      length.QuadPart = static_cast<LONGLONG>(size);
+      if (!SetFilePointerEx(file, length, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+      {
+         CloseHandle(file);
+         return false;
+      }
+   }
+   else
+   {
+      LARGE_INTEGER length;
+      if (!GetFileSizeEx(file, &length))
+      {
+         CloseHandle(file);
+         return false;
+      }
+      size = static_cast<std::size_t>(length.QuadPart);
+   }
+
+   if (size == 0)
+   {
+      CloseHandle(file);
+      return false;
+   }
+
+   HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+   if (!mapping)
+   {
+      CloseHandle(file);
+      return false;
+   }
+
+   void* view = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+   if (!view)
+   {
+      CloseHandle(mapping);
+      CloseHandle(file);
+      return false;
+   }
+
+   m_file = file;
+   m_mapping = mapping;
+   m_data = static_cast<char*>(view);
+   m_size = size;
+   m_writable = writable;
+   return true;
+}
+
+bool MappedFile::Flush(const std::size_t offset, const std::size_t length)
+{
+   if (!m_data || !m_writable)
+      return false;
+
+   return FlushViewOfFile(m_data + offset, length) && FlushFileBuffers(static_cast<HANDLE>(m_file));
+}
+
+void MappedFile::AdviseSequential()
+{
+   // Mapped views have no access-pattern hint on Windows.
+}
+
+// Description: Trims the range from the working set; unlocking pages that
+// were never locked evicts them.
+void MappedFile::Release(const std::size_t offset, const std::size_t length)
+{
+   if (m_data && length != 0)
+      (void)VirtualUnlock(m_data + offset, length);
+}
+
+void MappedFile::Close()
+{
+   if (m_data)
+      UnmapViewOfFile(m_data);
+   if (m_mapping)
+      CloseHandle(static_cast<HANDLE>(m_mapping));
+   if (m_file)
+      CloseHandle(static_cast<HANDLE>(m_file));
+
+   m_data = nullptr;
+   m_mapping = nullptr;
+   m_file = nullptr;
+   m_size = 0;
+}
+
+#else
+
+// Description: Opens (or creates and preallocates) the file and maps all of it.
+bool MappedFile::Map(const std::string& path, std::size_t size, const bool create, const bool writable)
+{
+   Close();
+
+   const int flags = writable ? (O_RDWR | (create ? (O_CREAT | O_TRUNC) : 0)) : O_RDONLY;
+   const int fd = ::open(path.c_str(), flags, 0644);
+   if (fd < 0)
+      return false;
+
+   if (create)
+   {
+      if (::ftruncate(fd, static_cast<off_t>(size)) != 0)
+      {
+         ::close(fd);
+         return false;
+      }
+#ifdef __linux__
+      // Reserve the blocks now so appends never hit ENOSPC through a page fault.
+      (void)::posix_fallocate(fd, 0, static_cast<off_t>(size));
+#endif
+   }
+   else
+   {
+      struct stat info;
+      if (::fstat(fd, &info) != 0)
+      {
+         ::close(fd);
+         return false;
+      }
+      size = static_cast<std::size_t>(info.st_size);
+   }
+
+   if (size == 0)
+   {
+      ::close(fd);
+      return false;
+   }
+
+   void* view = ::mmap(nullptr, size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+   if (view == MAP_FAILED)
+   {
+      ::close(fd);
+      return false;
+   }
+
+   m_fd = fd;
+   m_data = static_cast<char*>(view);
+   m_size = size;
+   m_writable = writable;
+   return true;
+}
+
+bool MappedFile::Flush(const std::size_t offset, const std::size_t length)
+{
+   if (!m_data || !m_writable)
+      return false;
+
+   // msync wants a page-aligned start.
+   const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+   const std::size_t start = offset - (offset % page);
+
+   return ::msync(m_data + start, length + (offset - start), MS_SYNC) == 0;
+}
+
+void MappedFile::AdviseSequential()
+{
+   if (m_data)
+      (void)::madvise(m_data, m_size, MADV_SEQUENTIAL);
+}
+
+// Description: Drops the whole pages inside the range. The file is mapped
+// shared, so nothing is lost; the pages are simply read again if touched.
+void MappedFile::Release(const std::size_t offset, const std::size_t length)
+{
+   if (!m_data)
+      return;
+
+   const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+   const std::size_t start = (offset + page - 1) / page * page;
+   const std::size_t end = (offset + length) / page * page;
+
+   if (end > start)
+      (void)::madvise(m_data + start, end - start, MADV_DONTNEED);
+}
+
+void MappedFile::Close()
+{
+   if (m_data)
+      ::munmap(m_data, m_size);
+   if (m_fd >= 0)
+      ::close(m_fd);
+
+   m_data = nullptr;
+   m_fd = -1;
+   m_size = 0;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// A file mapped into memory in one piece. Create preallocates the file to
+// the requested size so later writes never extend it; OpenReadOnly maps an
+// existing file as it is. Flush writes a byte range back to disk and waits
+// for it (msync / FlushViewOfFile + FlushFileBuffers).
+class MappedFile
+{
+public:
+   MappedFile() = default;
+   ~MappedFile() { Close(); }
+
+   MappedFile(const MappedFile&) = delete;
+   MappedFile& operator=(const MappedFile&) = delete;
+
+   bool Create(const std::string& path, std::size_t size);
+   bool OpenReadWrite(const std::string& path);
+   bool OpenReadOnly(const std::string& path);
+   bool Flush(std::size_t offset, std::size_t length);
+
+   // Hints for streaming a large read-only file: read ahead aggressively,
+   // and drop the pages of a range already consumed so that resident memory
+   // stays bounded however big the file is.
+   void AdviseSequential();
+   void Release(std::size_t offset, std::size_t length);
+   void Close();
+
+   bool IsOpen() const { return m_data != nullptr; }
+   char* GetData() { return m_data; }
+   const char* GetData() const { return m_data; }
+   std::size_t GetSize() const { return m_size; }
+
+private:
+   char* m_data = nullptr;
+   std::size_t m_size = 0;
+   bool m_writable = false;
+
+#ifdef _WIN32
+   void* m_file = nullptr;
+   void* m_mapping = nullptr;
+#else
+   int m_fd = -1;
+#endif
+
+   bool Map(const std::string& path, std::size_t size, bool create, bool writable);
+};
+
+#endif
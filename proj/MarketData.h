@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+#include "OrderDetails.h"
+
+// One aggregated price level, as returned by Orderbook::GetDepth.
+struct DepthLevel
+{
+   Price price;
+   Volume volume;
+   std::size_t orderCount;
+};
+
+// Published whenever a level's aggregate changes. volume and orderCount are
+// the level's new totals (both zero once the level is gone), so a consumer
+// maintains its L2 view by overwriting its copy of the level.
+struct LevelUpdate
+{
+   Side side;
+   Price price;
+   Volume volume;
+   std::size_t orderCount;
+};
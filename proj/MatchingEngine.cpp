@@ -0,0 +1,138 @@
+#include "MatchingEngine.h"
+#include "ThreadAffinity.h"
+
+// Description: Runs one command against a book and reports its result.
+EngineResponse ApplyCommand(Orderbook& book, const EngineCommand& command)
+{
+   switch (command.type)
+   {
+      case CommandType::New:
+      {
+         Order order(command.orderType, command.orderId, command.price, command.side, command.volume,
+                     command.stopPrice);
+         order.SetOwner(command.owner);
+         order.SetSelfTradePrevention(command.selfTradePrevention);
+         order.SetExpiry(command.expiry);
+         const OrderOutcome outcome = book.ExecuteTrade(order);
+         return {command.type, outcome, outcome != OrderOutcome::Cancelled, command.orderId};
+      }
+
+      case CommandType::Cancel:
+         return {command.type, OrderOutcome::Cancelled, book.CancelOrder(command.orderId), command.orderId};
+
+      case CommandType::Modify:
+         return {command.type, OrderOutcome::AddedToOrderbook,
+                 book.ModifyOrder(command.orderId, command.price, command.volume), command.orderId};
+
+      case CommandType::CancelAll:
+         return {command.type, OrderOutcome::Cancelled, book.CancelAll(command.side) != 0, command.orderId};
+
+      case CommandType::CancelRange:
+         return {command.type, OrderOutcome::Cancelled,
+                 book.CancelRange(command.side, command.price, command.stopPrice) != 0, command.orderId};
+
+      case CommandType::CancelByOwner:
+         return {command.type, OrderOutcome::Cancelled, book.CancelByOwner(command.owner) != 0, command.orderId};
+
+      case CommandType::AdvanceTime:
+         return {command.type, OrderOutcome::Cancelled, book.AdvanceTime(command.expiry) != 0, command.orderId};
+
+      default:
+         return {command.type, OrderOutcome::Cancelled, false, command.orderId};
+   }
+}
+
+MatchingEngine::MatchingEngine(const std::size_t producers, const std::size_t queueCapacity,
+                               const double tickSize, const OrderbookCapacity& capacity)
+   :
+   book(tickSize, capacity)
+{
+   channels.reserve(producers);
+   for (std::size_t i = 0; i < producers; ++i)
+      channels.push_back(std::make_unique<Channel>(queueCapacity));
+}
+
+MatchingEngine::~MatchingEngine()
+{
+   Stop();
+}
+
+// Description: Launches the matching thread.
+void MatchingEngine::Start(const int core)
+{
+   if (running.exchange(true))
+      return;
+
+   matcher = std::thread(&MatchingEngine::Run, this, core);
+}
+
+// Description: Signals the matching thread to finish the queued commands
+// and waits for it.
+void MatchingEngine::Stop()
+{
+   running.store(false, std::memory_order_release);
+
+   if (matcher.joinable())
+      matcher.join();
+}
+
+bool MatchingEngine::Submit(const std::size_t producer, const EngineCommand& command)
+{
+   return channels[producer]->commands.TryPush(command);
+}
+
+bool MatchingEngine::PollResponse(const std::size_t producer, EngineResponse& response)
+{
+   return channels[producer]->responses.TryPop(response);
+}
+
+// Description: Matching thread body. Spins over the producer rings, backing
+// off with a yield only after a run of empty passes.
+void MatchingEngine::Run(const int core)
+{
+   PinCurrentThread(core);
+
+   constexpr int idlePassesBeforeYield = 64;
+   int idlePasses = 0;
+
+   while (running.load(std::memory_order_acquire))
+   {
+      if (DrainOnce() != 0)
+      {
+         idlePasses = 0;
+      }
+      else if (++idlePasses >= idlePassesBeforeYield)
+      {
+         idlePasses = 0;
+         std::this_thread::yield();
+      }
+   }
+
+   while (DrainOnce() != 0)
+   {
+   }
+}
+
+// Description: Takes at most one batch from each producer ring in turn so a
+// busy producer cannot starve the others. Returns the number applied.
+std::size_t MatchingEngine::DrainOnce()
+{
+   constexpr std::size_t batchSize = 32;
+   std::size_t applied = 0;
+   EngineCommand command;
+
+   for (auto& channel : channels)
+   {
+      for (std::size_t i = 0; i < batchSize && channel->commands.TryPop(command); ++i)
+      {
+         const EngineResponse response = ApplyCommand(book, command);
+
+         // Back-pressure on a full response ring, unless shutting down.
+         while (!channel->responses.TryPush(response) && running.load(std::memory_order_acquire))
+            std::this_thread::yield();
+
+         ++applied;
+      }
+   }
+   return applied;
+}
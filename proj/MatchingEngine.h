@@ -0,0 +1,63 @@
+#ifndef MATCHINGENGINE_H
+#define MATCHINGENGINE_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "EngineCommand.h"
+#include "OrderBook.h"
+#include "SpscQueue.h"
+
+// Runs one Orderbook on a dedicated matching thread. Each gateway (producer)
+// gets its own lock-free command ring and response ring; the matching
+// thread fans the command rings in round-robin, applies each command to the
+// book and answers on the producer's response ring. The book itself is only
+// ever touched by the matching thread, so matching stays single-writer and
+// deterministic per producer while ingress scales across cores.
+class MatchingEngine
+{
+public:
+   MatchingEngine(std::size_t producers, std::size_t queueCapacity = 65536,
+                  double tickSize = 1.0, const OrderbookCapacity& capacity = {});
+   ~MatchingEngine();
+
+   MatchingEngine(const MatchingEngine&) = delete;
+   MatchingEngine& operator=(const MatchingEngine&) = delete;
+
+   // Starts the matching thread, pinned to core when core >= 0.
+   void Start(int core = -1);
+
+   // Applies every command already queued, then joins the matching thread.
+   void Stop();
+
+   // Producer side. Each producer index must be used by one thread only.
+   // Submit returns false when that producer's ring is full.
+   bool Submit(std::size_t producer, const EngineCommand& command);
+   bool PollResponse(std::size_t producer, EngineResponse& response);
+
+   std::size_t GetProducerCount() const { return channels.size(); }
+
+   // Direct access to the book; only safe while the engine is stopped.
+   Orderbook& GetBook() { return book; }
+
+private:
+   struct Channel
+   {
+      explicit Channel(std::size_t capacity) : commands(capacity), responses(capacity) {}
+
+      SpscQueue<EngineCommand> commands;
+      SpscQueue<EngineResponse> responses;
+   };
+
+   Orderbook book;
+   std::vector<std::unique_ptr<Channel>> channels;
+   std::atomic<bool> running{false};
+   std::thread matcher;
+
+   void Run(int core);
+   std::size_t DrainOnce();
+};
+
+#endif
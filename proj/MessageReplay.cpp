@@ -0,0 +1,134 @@
+#include "MessageReplay.h"
+#include "OrderBook.h"
+
+#include <charconv>
+#include <cstring>
+
+// Description: Returns the next line that parses, skipping blank and
+// malformed ones.
+bool LobsterCsvReader::Next(ReplayMessage& message)
+{
+   while (m_cursor < m_end)
+   {
+      const char* line = m_cursor;
+      const char* lineEnd = static_cast<const char*>(std::memchr(line, '\n', static_cast<std::size_t>(m_end - line)));
+      if (!lineEnd)
+         lineEnd = m_end;
+
+      m_cursor = (lineEnd < m_end) ? lineEnd + 1 : m_end;
+
+      if (lineEnd > line && lineEnd[-1] == '\r')
+         --lineEnd;
+      if (lineEnd == line)
+         continue;
+
+      if (ParseLine(line, lineEnd, message))
+         return true;
+      ++m_malformed;
+   }
+   return false;
+}
+
+// Description: Parses "time,type,id,size,price,direction", where time is
+// decimal seconds after midnight and direction is 1 (buy) or -1 (sell).
+bool LobsterCsvReader::ParseLine(const char* line, const char* lineEnd, ReplayMessage& message) const
+{
+   const char* p = line;
+
+   auto parse = [&p, lineEnd](auto& value)
+   {
+      const auto [next, error] = std::from_chars(p, lineEnd, value);
+      if (error != std::errc())
+         return false;
+      p = next;
+      return true;
+   };
+   auto comma = [&p, lineEnd]()
+   {
+      if (p == lineEnd || *p != ',')
+         return false;
+      ++p;
+      return true;
+   };
+
+   std::int64_t seconds = 0;
+   if (!parse(seconds))
+      return false;
+
+   std::int64_t nanoseconds = 0;
+   if (p != lineEnd && *p == '.')
+   {
+      std::int64_t scale = 100000000;
+      for (++p; p != lineEnd && *p >= '0' && *p <= '9'; ++p, scale /= 10)
+         nanoseconds += (*p - '0') * scale;
+   }
+
+   int type = 0;
+   int direction = 0;
+   if (!comma() || !parse(type) || !comma() || !parse(message.orderId) || !comma() ||
+       !parse(message.size) || !comma() || !parse(message.price) || !comma() || !parse(direction))
+   {
+      return false;
+   }
+
+   if (type < 1 || type > 7 || (direction != 1 && direction != -1))
+      return false;
+
+   message.timestamp = seconds * 1000000000 + nanoseconds;
+   message.type = static_cast<ReplayEventType>(type);
+   message.side = (direction == 1) ? Side::Buy : Side::Sell;
+   std::memset(message.padding, 0, sizeof(message.padding));
+   return true;
+}
+
+bool BinaryMessageReader::Next(ReplayMessage& message)
+{
+   if (static_cast<std::size_t>(m_end - m_cursor) < sizeof(ReplayMessage))
+      return false;
+
+   std::memcpy(&message, m_cursor, sizeof(message));
+   m_cursor += sizeof(message);
+   return true;
+}
+
+// Description: Applies one historical message to the book.
+ReplayResult MessageReplayer::Apply(const ReplayMessage& message)
+{
+   switch (message.type)
+   {
+      case ReplayEventType::Submission:
+      {
+         Order order(OrderType::GoodTillCancel, message.orderId, message.price, message.side, message.size);
+         (void)book.ExecuteTrade(order);
+         return ReplayResult::Applied;
+      }
+
+      case ReplayEventType::PartialCancel:
+      {
+         const std::optional<Order> order = book.FindOrder(message.orderId);
+         if (!order)
+            return ReplayResult::UnknownOrder;
+
+         (void)book.ModifyOrder(message.orderId, order->GetPrice(), order->GetRemainingVolume() - message.size);
+         return ReplayResult::Applied;
+      }
+
+      case ReplayEventType::Deletion:
+         return book.CancelOrder(message.orderId) ? ReplayResult::Applied : ReplayResult::UnknownOrder;
+
+      case ReplayEventType::VisibleExecution:
+      {
+         const std::optional<Order> order = book.FindOrder(message.orderId);
+         if (!order)
+            return ReplayResult::UnknownOrder;
+
+         const Side aggressor = (order->GetSide() == Side::Buy) ? Side::Sell : Side::Buy;
+         Order taker(OrderType::ImmediateOrCancel, nextAggressorId++, order->GetPrice(), aggressor, message.size);
+         (void)book.ExecuteTrade(taker);
+         return ReplayResult::Applied;
+      }
+
+      default:
+         return ReplayResult::Skipped;
+   }
+}
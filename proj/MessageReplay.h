@@ -0,0 +1,101 @@
+#ifndef MESSAGEREPLAY_H
+#define MESSAGEREPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "OrderDetails.h"
+
+class Orderbook;
+
+// Event types as numbered in LOBSTER message files.
+enum class ReplayEventType : std::uint8_t
+{
+   Submission = 1,
+   PartialCancel = 2,
+   Deletion = 3,
+   VisibleExecution = 4,
+   HiddenExecution = 5,
+   CrossTrade = 6,
+   Halt = 7
+};
+
+// One historical message. This is also the record layout of the binary
+// message format, which is simply an array of these.
+struct ReplayMessage
+{
+   std::int64_t timestamp;   // nanoseconds after midnight
+   ID orderId;
+   Price price;              // in ticks; LOBSTER prices are dollars x 10000
+   Volume size;
+   Side side;                // side of the order the message is about
+   ReplayEventType type;
+   std::uint8_t padding[3];
+};
+
+static_assert(sizeof(ReplayMessage) == 40, "replay messages are fixed width");
+
+// Parses LOBSTER message CSV (time,type,id,size,price,direction) straight
+// out of a mapped buffer: fields are read in place, nothing is copied or
+// allocated. Lines that do not parse are skipped and counted.
+class LobsterCsvReader
+{
+public:
+   LobsterCsvReader(const char* begin, const char* end) : m_cursor(begin), m_begin(begin), m_end(end) {}
+
+   bool Next(ReplayMessage& message);
+
+   std::size_t GetOffset() const { return static_cast<std::size_t>(m_cursor - m_begin); }
+   std::size_t GetMalformedCount() const { return m_malformed; }
+
+private:
+   const char* m_cursor;
+   const char* m_begin;
+   const char* m_end;
+   std::size_t m_malformed = 0;
+
+   bool ParseLine(const char* line, const char* lineEnd, ReplayMessage& message) const;
+};
+
+// Steps through a buffer of binary ReplayMessage records.
+class BinaryMessageReader
+{
+public:
+   BinaryMessageReader(const char* begin, const char* end) : m_cursor(begin), m_begin(begin), m_end(end) {}
+
+   bool Next(ReplayMessage& message);
+
+   std::size_t GetOffset() const { return static_cast<std::size_t>(m_cursor - m_begin); }
+
+private:
+   const char* m_cursor;
+   const char* m_begin;
+   const char* m_end;
+};
+
+enum class ReplayResult
+{
+   Applied,
+   Skipped,        // no effect on the visible book (hidden executions, halts)
+   UnknownOrder    // refers to an order that is not resting, e.g. from before the file starts
+};
+
+// Maps historical messages onto the book's entry points. Submissions are
+// new GoodTillCancel orders; partial cancels reduce the order's volume
+// through ModifyOrder; deletions are CancelOrder; a visible execution is
+// replayed as an ImmediateOrCancel order against the resting order's price
+// for the executed size. Those aggressors take IDs from a range far above
+// any exchange order ID.
+class MessageReplayer
+{
+public:
+   explicit MessageReplayer(Orderbook& book) : book(book) {}
+
+   ReplayResult Apply(const ReplayMessage& message);
+
+private:
+   Orderbook& book;
+   ID nextAggressorId = ID{1} << 62;
+};
+
+#endif
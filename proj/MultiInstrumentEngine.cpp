@@ -0,0 +1,317 @@
+#include "MultiInstrumentEngine.h"
+#include "ThreadAffinity.h"
+
+#include <functional>
+
+MultiInstrumentEngine::MultiInstrumentEngine(const std::size_t workerCount, const std::size_t producers,
+                                             const std::size_t queueCapacity)
+   :
+   responses(producers),
+   nextResponseRing(producers, 0)
+{
+   workers.reserve(workerCount);
+   for (std::size_t w = 0; w < workerCount; ++w)
+   {
+      auto worker = std::make_unique<Worker>();
+      for (std::size_t p = 0; p < producers; ++p)
+         worker->inbound.push_back(std::make_unique<SpscQueue<InstrumentCommand>>(queueCapacity));
+      workers.push_back(std::move(worker));
+   }
+
+   for (auto& perProducer : responses)
+   {
+      for (std::size_t w = 0; w < workerCount; ++w)
+         perProducer.push_back(std::make_unique<SpscQueue<InstrumentResponse>>(queueCapacity));
+   }
+}
+
+MultiInstrumentEngine::~MultiInstrumentEngine()
+{
+   Stop();
+}
+
+// Description: Creates a book for a symbol and assigns it to a worker,
+// either explicitly or by hashing the symbol.
+SymbolID MultiInstrumentEngine::AddInstrument(const std::string& symbol, const double tickSize,
+                                              const OrderbookCapacity& capacity, const int worker)
+{
+   const SymbolID id = static_cast<SymbolID>(instruments.size());
+   const std::size_t owner = (worker >= 0) ? static_cast<std::size_t>(worker) % workers.size()
+                                           : std::hash<std::string>{}(symbol) % workers.size();
+
+   auto instrument = std::make_unique<Instrument>();
+   instrument->symbol = symbol;
+   instrument->owner.store(static_cast<std::uint32_t>(owner));
+   instruments.push_back(std::move(instrument));
+   directory[symbol] = id;
+
+   for (std::size_t w = 0; w < workers.size(); ++w)
+      workers[w]->books.resize(instruments.size());
+   workers[owner]->books[id] = std::make_unique<Orderbook>(tickSize, capacity);
+
+   return id;
+}
+
+bool MultiInstrumentEngine::FindInstrument(const std::string& symbol, SymbolID& id) const
+{
+   auto it = directory.find(symbol);
+   if (it == directory.end())
+      return false;
+
+   id = it->second;
+   return true;
+}
+
+void MultiInstrumentEngine::Start(const std::vector<int>& cores)
+{
+   if (running.exchange(true))
+      return;
+
+   for (std::size_t w = 0; w < workers.size(); ++w)
+   {
+      const int core = (w < cores.size()) ? cores[w] : -1;
+      workers[w]->thread = std::thread(&MultiInstrumentEngine::Run, this, w, core);
+   }
+}
+
+void MultiInstrumentEngine::Stop()
+{
+   running.store(false, std::memory_order_release);
+
+   for (auto& worker : workers)
+   {
+      if (worker->thread.joinable())
+         worker->thread.join();
+   }
+}
+
+// Description: Routes a command to the worker that currently owns the
+// symbol. The in-flight count lets a migrating owner know when no producer
+// can still be pushing to it on a stale lookup.
+bool MultiInstrumentEngine::Submit(const std::size_t producer, const SymbolID symbol, const EngineCommand& command)
+{
+   Instrument& instrument = *instruments[symbol];
+
+   instrument.inFlight.fetch_add(1);
+   const std::uint32_t owner = instrument.owner.load();
+   const bool pushed = workers[owner]->inbound[producer]->TryPush({symbol, command});
+   instrument.inFlight.fetch_sub(1);
+
+   return pushed;
+}
+
+// Description: Polls the producer's response rings in rotation.
+bool MultiInstrumentEngine::PollResponse(const std::size_t producer, InstrumentResponse& response)
+{
+   auto& rings = responses[producer];
+
+   for (std::size_t i = 0; i < rings.size(); ++i)
+   {
+      const std::size_t ring = nextResponseRing[producer];
+      nextResponseRing[producer] = (ring + 1) % rings.size();
+
+      if (rings[ring]->TryPop(response))
+         return true;
+   }
+   return false;
+}
+
+void MultiInstrumentEngine::MoveInstrument(const SymbolID symbol, const std::size_t targetWorker)
+{
+   const std::uint32_t target = static_cast<std::uint32_t>(targetWorker % workers.size());
+   const std::uint32_t owner = instruments[symbol]->owner.load();
+
+   if (owner == target)
+      return;
+
+   outstandingMoves.fetch_add(1);
+   PostControl(owner, {ControlType::Release, symbol, target, nullptr});
+}
+
+std::size_t MultiInstrumentEngine::GetOwner(const SymbolID symbol) const
+{
+   return instruments[symbol]->owner.load();
+}
+
+Orderbook& MultiInstrumentEngine::GetBook(const SymbolID symbol)
+{
+   return *workers[GetOwner(symbol)]->books[symbol];
+}
+
+// Description: Worker thread body. Keeps going after Stop until its rings,
+// parked commands and any moves in flight are all settled.
+void MultiInstrumentEngine::Run(const std::size_t index, const int core)
+{
+   PinCurrentThread(core);
+
+   constexpr int idlePassesBeforeYield = 64;
+   int idlePasses = 0;
+
+   while (running.load(std::memory_order_acquire) || !IsIdle(index))
+   {
+      ProcessControl(index);
+      const std::size_t applied = DrainOnce(index);
+      CompleteHandoffs(index);
+
+      if (applied != 0)
+      {
+         idlePasses = 0;
+      }
+      else if (++idlePasses >= idlePassesBeforeYield)
+      {
+         idlePasses = 0;
+         std::this_thread::yield();
+      }
+   }
+}
+
+// Description: Takes a batch from each producer ring in turn.
+std::size_t MultiInstrumentEngine::DrainOnce(const std::size_t index)
+{
+   constexpr std::size_t batchSize = 32;
+   Worker& worker = *workers[index];
+   std::size_t applied = 0;
+   InstrumentCommand command;
+
+   for (std::size_t producer = 0; producer < worker.inbound.size(); ++producer)
+   {
+      for (std::size_t i = 0; i < batchSize && worker.inbound[producer]->TryPop(command); ++i)
+      {
+         Apply(index, producer, command);
+         ++applied;
+      }
+   }
+   return applied;
+}
+
+// Description: Runs a command against the worker's book for the symbol, or
+// parks it if the book is still on its way from the previous owner.
+void MultiInstrumentEngine::Apply(const std::size_t index, const std::size_t producer, const InstrumentCommand& command)
+{
+   Worker& worker = *workers[index];
+   Orderbook* book = worker.books[command.symbol].get();
+
+   if (!book)
+   {
+      worker.parked[command.symbol].push_back({producer, command});
+      return;
+   }
+
+   const InstrumentResponse response{command.symbol, ApplyCommand(*book, command.command)};
+   auto& ring = *responses[producer][index];
+
+   while (!ring.TryPush(response) && running.load(std::memory_order_acquire))
+      std::this_thread::yield();
+}
+
+// Description: Handles migration messages posted to this worker.
+void MultiInstrumentEngine::ProcessControl(const std::size_t index)
+{
+   Worker& worker = *workers[index];
+
+   if (!worker.hasControl.load(std::memory_order_acquire))
+      return;
+
+   std::deque<ControlMessage> messages;
+   {
+      std::lock_guard<std::mutex> lock(worker.controlMutex);
+      messages.swap(worker.control);
+      worker.hasControl.store(false, std::memory_order_release);
+   }
+
+   for (ControlMessage& message : messages)
+   {
+      Instrument& instrument = *instruments[message.symbol];
+
+      if (message.type == ControlType::Adopt)
+      {
+         worker.books[message.symbol] = std::move(message.book);
+
+         auto parked = worker.parked.find(message.symbol);
+         if (parked != worker.parked.end())
+         {
+            std::deque<ParkedCommand> waiting = std::move(parked->second);
+            worker.parked.erase(parked);
+            for (const ParkedCommand& entry : waiting)
+               Apply(index, entry.producer, entry.command);
+         }
+         outstandingMoves.fetch_sub(1);
+         continue;
+      }
+
+      // Release: only the settled owner can start a handoff; otherwise the
+      // symbol is mid-move, so pass the request on to whoever owns it next.
+      bool handingOff = false;
+      for (const Handoff& handoff : worker.handoffs)
+         handingOff |= handoff.symbol == message.symbol;
+
+      if (!worker.books[message.symbol] || handingOff)
+      {
+         PostControl(instrument.owner.load(), std::move(message));
+         continue;
+      }
+
+      if (message.target == index)
+      {
+         outstandingMoves.fetch_sub(1);
+         continue;
+      }
+
+      // Redirect producers, then wait out any that read the old owner just
+      // before the switch; after that nothing new for this symbol lands here.
+      instrument.owner.store(message.target);
+      while (instrument.inFlight.load() != 0)
+         std::this_thread::yield();
+
+      Handoff handoff{message.symbol, message.target, {}};
+      for (const auto& ring : worker.inbound)
+         handoff.drainTo.push_back(ring->GetPushedCount());
+      worker.handoffs.push_back(std::move(handoff));
+   }
+}
+
+// Description: Sends books whose last routed commands have been applied.
+void MultiInstrumentEngine::CompleteHandoffs(const std::size_t index)
+{
+   Worker& worker = *workers[index];
+
+   for (auto it = worker.handoffs.begin(); it != worker.handoffs.end(); )
+   {
+      bool drained = true;
+      for (std::size_t producer = 0; producer < worker.inbound.size(); ++producer)
+         drained &= worker.inbound[producer]->GetPoppedCount() >= it->drainTo[producer];
+
+      if (!drained)
+      {
+         ++it;
+         continue;
+      }
+
+      PostControl(it->target, {ControlType::Adopt, it->symbol, it->target, std::move(worker.books[it->symbol])});
+      it = worker.handoffs.erase(it);
+   }
+}
+
+void MultiInstrumentEngine::PostControl(const std::size_t index, ControlMessage message)
+{
+   Worker& worker = *workers[index];
+   std::lock_guard<std::mutex> lock(worker.controlMutex);
+
+   worker.control.push_back(std::move(message));
+   worker.hasControl.store(true, std::memory_order_release);
+}
+
+bool MultiInstrumentEngine::IsIdle(const std::size_t index)
+{
+   Worker& worker = *workers[index];
+
+   if (worker.hasControl.load(std::memory_order_acquire) || !worker.handoffs.empty() || !worker.parked.empty())
+      return false;
+
+   for (const auto& ring : worker.inbound)
+   {
+      if (!ring->empty())
+         return false;
+   }
+   return outstandingMoves.load() == 0;
+}
@@ -0,0 +1,147 @@
+#ifndef MULTIINSTRUMENTENGINE_H
+#define MULTIINSTRUMENTENGINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "EngineCommand.h"
+#include "OrderBook.h"
+#include "SpscQueue.h"
+
+using SymbolID = std::uint32_t;
+
+struct InstrumentCommand
+{
+   SymbolID symbol;
+   EngineCommand command;
+};
+
+struct InstrumentResponse
+{
+   SymbolID symbol;
+   EngineResponse response;
+};
+
+// Many Orderbooks sharded across worker threads. Every instrument is owned
+// by exactly one worker, which is the only thread that touches its book, so
+// independent symbols match in parallel while each book stays single-writer.
+//
+// Gateways (producers) route a command by looking up the symbol's current
+// owner and pushing onto that worker's ring for the producer; responses come
+// back on one ring per (producer, worker) pair. Order IDs are per book.
+//
+// MoveInstrument migrates one symbol between workers while everything else
+// keeps running. The old owner redirects new traffic, waits for commands
+// already routed to it to be applied, then hands the book over; the new
+// owner parks any commands that reach it first and replays them on arrival,
+// so each producer's commands for the symbol still apply in submit order.
+class MultiInstrumentEngine
+{
+public:
+   MultiInstrumentEngine(std::size_t workers, std::size_t producers, std::size_t queueCapacity = 65536);
+   ~MultiInstrumentEngine();
+
+   MultiInstrumentEngine(const MultiInstrumentEngine&) = delete;
+   MultiInstrumentEngine& operator=(const MultiInstrumentEngine&) = delete;
+
+   // Registers a symbol before Start. worker < 0 assigns by symbol hash.
+   SymbolID AddInstrument(const std::string& symbol, double tickSize = 1.0,
+                          const OrderbookCapacity& capacity = {}, int worker = -1);
+   bool FindInstrument(const std::string& symbol, SymbolID& id) const;
+
+   // Starts the workers; cores[i], when given and >= 0, pins worker i.
+   void Start(const std::vector<int>& cores = {});
+
+   // Applies everything already submitted, completes pending moves, then joins.
+   void Stop();
+
+   // Producer side; each producer index must be used by one thread only.
+   bool Submit(std::size_t producer, SymbolID symbol, const EngineCommand& command);
+   bool PollResponse(std::size_t producer, InstrumentResponse& response);
+
+   // Asynchronously moves a symbol to another worker. Safe from any thread
+   // while running; ignored if the symbol already lives there.
+   void MoveInstrument(SymbolID symbol, std::size_t targetWorker);
+   std::size_t GetOwner(SymbolID symbol) const;
+
+   // Direct access to a book; only safe while the engine is stopped.
+   Orderbook& GetBook(SymbolID symbol);
+
+   std::size_t GetWorkerCount() const { return workers.size(); }
+
+private:
+   struct Instrument
+   {
+      std::string symbol;
+      std::atomic<std::uint32_t> owner{0};
+      std::atomic<std::uint32_t> inFlight{0};
+   };
+
+   enum class ControlType
+   {
+      Release,   // sent to the owner: hand this symbol to target
+      Adopt      // sent to the target: here is the book
+   };
+
+   struct ControlMessage
+   {
+      ControlType type;
+      SymbolID symbol;
+      std::uint32_t target;
+      std::unique_ptr<Orderbook> book;
+   };
+
+   // A release in progress: the book goes once every inbound ring has been
+   // consumed up to the counts recorded when traffic was redirected.
+   struct Handoff
+   {
+      SymbolID symbol;
+      std::uint32_t target;
+      std::vector<std::size_t> drainTo;
+   };
+
+   struct ParkedCommand
+   {
+      std::size_t producer;
+      InstrumentCommand command;
+   };
+
+   struct Worker
+   {
+      std::vector<std::unique_ptr<SpscQueue<InstrumentCommand>>> inbound;   // one per producer
+      std::vector<std::unique_ptr<Orderbook>> books;                        // by SymbolID, null if not owned
+      std::unordered_map<SymbolID, std::deque<ParkedCommand>> parked;       // waiting for an adopted book
+      std::vector<Handoff> handoffs;
+
+      std::mutex controlMutex;
+      std::deque<ControlMessage> control;
+      std::atomic<bool> hasControl{false};
+
+      std::thread thread;
+   };
+
+   std::vector<std::unique_ptr<Instrument>> instruments;
+   std::unordered_map<std::string, SymbolID> directory;
+   std::vector<std::unique_ptr<Worker>> workers;
+   std::vector<std::vector<std::unique_ptr<SpscQueue<InstrumentResponse>>>> responses;   // [producer][worker]
+   std::vector<std::size_t> nextResponseRing;
+   std::atomic<bool> running{false};
+   std::atomic<std::size_t> outstandingMoves{0};
+
+   void Run(std::size_t index, int core);
+   std::size_t DrainOnce(std::size_t index);
+   void Apply(std::size_t index, std::size_t producer, const InstrumentCommand& command);
+   void ProcessControl(std::size_t index);
+   void CompleteHandoffs(std::size_t index);
+   void PostControl(std::size_t index, ControlMessage message);
+   bool IsIdle(std::size_t index);
+};
+
+#endif
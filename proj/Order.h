@@ -1,16 +1,21 @@
+#pragma once
+
 #include "OrderDetails.h"
 
 class Order
 {
 public:
-   Order(OrderType orderType, ID id, Price price, Side side, Volume volume)
+   // stopPrice is the trigger for Stop and StopLimit orders; price is the
+   // limit a StopLimit becomes once triggered.
+   Order(OrderType orderType, ID id, Price price, Side side, Volume volume, Price stopPrice = 0)
       :
-      m_orderType(orderType),
       m_id(id),
       m_price(price),
-      m_side(side),
       m_initialVolume(volume),
-      m_remainingVolume(volume)
+      m_remainingVolume(volume),
+      m_stopPrice(stopPrice),
+      m_orderType(orderType),
+      m_side(side)
    {}
 
    ID GetId() const { return m_id; }
@@ -19,14 +24,27 @@ public:
    OrderType GetType() const { return m_orderType; }
    Volume GetInitialVolume() const { return m_initialVolume; }
    Volume GetRemainingVolume() const { return m_remainingVolume; }
+   Price GetStopPrice() const { return m_stopPrice; }
+   OwnerID GetOwner() const { return m_owner; }
+   SelfTradePrevention GetSelfTradePrevention() const { return m_selfTradePrevention; }
+   Timestamp GetExpiry() const { return m_expiry; }
 
    void SetRemainingVolume(Volume volume) { m_remainingVolume = volume; }
+   void SetPrice(Price price) { m_price = price; }
+   void SetOwner(OwnerID owner) { m_owner = owner; }
+   void SetSelfTradePrevention(SelfTradePrevention mode) { m_selfTradePrevention = mode; }
+   void SetExpiry(Timestamp expiry) { m_expiry = expiry; }
 
 private:
+   // Widest first, so the one-byte fields pack into the tail.
    ID m_id;
    Price m_price;
-   Side m_side;
-   OrderType m_orderType;
    Volume m_initialVolume;
    Volume m_remainingVolume;
+   Price m_stopPrice;
+   Timestamp m_expiry = 0;
+   OwnerID m_owner = 0;
+   OrderType m_orderType;
+   Side m_side;
+   SelfTradePrevention m_selfTradePrevention = SelfTradePrevention::None;
 };
\ No newline at end of file
@@ -1,16 +1,59 @@
 #ifndef ORDERBOOK_H
 #define ORDERBOOK_H
 
-#include <map>
-#include <deque>
+#include <iterator>
+#include <memory>
+#include <vector>
 #include <unordered_map>
+#include <memory_resource>
+#include <utility>
 #include <iostream>
+#include <cmath>
+#include <limits>
+#include <optional>
 
 #include "CompletedOrders.h"
+#include "CountingResource.h"
+#include "ExecutionEvent.h"
+#include "LatencyHistogram.h"
+#include "MarketData.h"
+#include "OrderIndex.h"
+#include "OrderSlab.h"
+#include "PriceLadder.h"
+#include "RingBuffer.h"
+#include "TimingWheel.h"
+
+// Client order IDs to the slots holding their orders. This is the one
+// hashed lookup an order-ID request pays; everything behind it indexes
+// the slab. IDs are the client's and may be sparse; slots are the book's,
+// dense, and reused once an order leaves.
+using OrderReference = OrderIndex;
+
+class Journal;
+class L3Encoder;
+struct EngineCommand;
+struct SnapshotLevel;
+struct SnapshotOrder;
+
+// Sizes the book's preallocated storage. Price levels and pooled nodes
+// are carved out of an arena at construction and recycled afterwards;
+// order slots and reference entries are reserved on the heap up front
+// and only reallocated if the book outgrows maxOrders. Either way
+// steady-state matching does not touch the heap.
+struct OrderbookCapacity
+{
+   std::size_t maxOrders = 4096;
+   std::size_t priceLevels = 4096;
+   std::size_t completedOrders = 4096;
+   std::size_t executionEvents = 4096;
+   std::size_t levelUpdates = 4096;
+   std::size_t stopLevels = 256;
+};
 
 class Orderbook
 {
 public:
+   explicit Orderbook(double tickSize = 1.0, const OrderbookCapacity& capacity = {});
 
    OrderOutcome ExecuteTrade(Order& order);
    ID GetNextOrderId() { return ++nextOrderID; }  // Helper to generate IDs
@@ -19,37 +62,270 @@ public:
    bool ModifyVolume(Order& order, Volume newVolume);
    bool CancelOrder(ID orderID);
 
+   // Mass cancels, each journalled as one command and returning the number
+   // of orders pulled. CancelAll and CancelRange (inclusive of both bounds)
+   // drop whole resting levels at once; every order still gets its
+   // Cancelled report and L3 delete, but each level only one LevelUpdate.
+   // CancelByOwner walks only that owner's orders, pending stops included,
+   // so it serves as cancel-on-disconnect; it too publishes one
+   // LevelUpdate per resting level it touches.
+   std::size_t CancelAll(Side side);
+   std::size_t CancelRange(Side side, Price low, Price high);
+   std::size_t CancelByOwner(OwnerID owner);
+
+   // Resting orders plus pending stops an owner has open, in O(1). Orders
+   // entered without an owner (0) are not counted.
+   std::size_t GetOpenOrderCount(OwnerID owner) const;
+
+   // Aggregate resting volume and order count at a price, read from the
+   // level's cached totals.
+   Volume GetVolumeAtPrice(Side side, Price price) const;
+   std::size_t GetOrderCountAtPrice(Side side, Price price) const;
+
+   // A copy of the resting order with this ID, or nothing if it is not on
+   // the book.
+   std::optional<Order> FindOrder(ID orderID) const;
+
+   // Up to levels aggregated price levels on one side, best first.
+   std::vector<DepthLevel> GetDepth(Side side, std::size_t levels) const;
+
+   // Price of the most recent fill, or 0 before the first trade.
+   Price GetLastTradePrice() const { return lastTradePrice; }
+
+   // Stop and StopLimit orders waiting for their trigger. A buy stop fires
+   // once a trade prints at or above its stop price, a sell stop at or
+   // below, whichever fill of a command it was; an order whose stop the
+   // last trade already crosses on entry fires at once.
+   std::size_t GetPendingStopCount() const { return stopReference.size(); }
+
+   // The book's clock, in whatever unit the caller uses for expiries. A
+   // GoodTillDate order expires at Order::GetExpiry; a Day order entered
+   // without one takes the session close in force at the time. Orders
+   // already past their expiry are rejected on entry.
+   Timestamp GetTime() const { return expiries.Now(); }
+   Timestamp GetSessionClose() const { return sessionClose; }
+   void SetSessionClose(Timestamp close) { sessionClose = close; }
+
+   // Moves the clock forward (never back) and expires every resting order
+   // that has come due, returning how many. Each gets an Expired report
+   // and L3 delete, and each level touched one LevelUpdate. Only the
+   // expiring orders are visited, never the rest of the book.
+   std::size_t AdvanceTime(Timestamp now);
+
+   // Conversions between decimal prices and the book's integer ticks.
+   double GetTickSize() const { return tickSize; }
+   Price ToTicks(double price) const { return std::llround(price / tickSize); }
+   double ToDecimalPrice(Price ticks) const { return static_cast<double>(ticks) * tickSize; }
+
+   // Every subsequent command is appended to the journal before it is
+   // applied. One the journal cannot take (full, or a required flush
+   // failed) is not applied: it gets a Rejected report, and the call
+   // returns Cancelled, false or 0. Pass nullptr to stop journalling.
+   void AttachJournal(Journal* target) { journal = target; }
+
+   // Every resting add, execution, cancel, replace and delete is encoded
+   // as an order-by-order message. Pass nullptr to stop.
+   void AttachL3Encoder(L3Encoder* target) { l3Encoder = target; }
+
+   // Writes the resting book (levels in priority order, each level's FIFO
+   // queue, pending stops, the last trade and the ID counter) to a
+   // snapshot file. With a journal attached
+   // the snapshot also records how many journal records it covers.
+   bool SaveSnapshot(const std::string& path) const;
+
+   // Loads a snapshot into an empty book with the same tick size. The
+   // journal position it was taken at is returned through journalPosition,
+   // so startup is LoadSnapshot followed by ReplayJournal from there.
+   bool LoadSnapshot(const std::string& path, std::uint64_t* journalPosition = nullptr);
+
+   // Recently finished orders. Once the retained window is full, older ones
+   // are streamed to the segment file if one has been set, else dropped.
+   const CompletedOrders& GetCompletedOrders() const { return completedOrders; }
+   bool SetCompletedOrdersSegment(const std::string& path) { return completedOrders.OpenSegment(path); }
+
+   // Execution reports (accept, fill, partial fill, cancel, modify) in the
+   // order they happened. Drain after each call; if the ring fills up the
+   // oldest reports are overwritten and counted as overruns.
+   RingBuffer<ExecutionEvent>& GetExecutionEvents() { return executionEvents; }
+
+   // Incremental L2 feed: one LevelUpdate each time a level's aggregate
+   // volume or order count changes, in the order the changes happened.
+   // Overflow overwrites the oldest updates, as with execution reports.
+   RingBuffer<LevelUpdate>& GetLevelUpdates() { return levelUpdates; }
+
+   // Number of times the book's pools have had to fall back to the heap.
+   // Flat after warm-up while the book stays within its capacity.
+   std::size_t GetHeapAllocationCount() const { return heapResource.GetAllocationCount(); }
+
+#ifdef LOB_LATENCY_STATS
+   // TSC latency of every ExecuteTrade (by order type and outcome),
+   // CancelOrder and ModifyOrder. Recorded by the thread driving the book;
+   // safe to read from any other thread while it runs. Only built when
+   // LOB_LATENCY_STATS is defined, so a normal build pays nothing for it.
+   const OrderbookLatency& GetLatencyStats() const { return *latencyStats; }
+#endif
+
    // I also want to add: current level - price last trade took place at and remaining cash on that level
    // Modify/Cancel order
    // Order history.
    // Unit tests.
 
 private:
-   static ID nextOrderID;
-   
-   std::map<Price, std::deque<Order>> asks;
-   std::map<Price, std::deque<Order>, std::greater<Price>> bids;
-   std::unordered_map<ID, OrderLocation> orderbookReference;
+   ID nextOrderID = 0;
+   double tickSize;
+   Price lastTradePrice = 0;
+   bool hasLastTrade = false;
+
+   // Lowest and highest fill prices since stops were last released. A
+   // command can print several prices, and a stop fires if any of them
+   // crossed it; empty (low above high) between commands.
+   Price tradeLow = std::numeric_limits<Price>::max();
+   Price tradeHigh = std::numeric_limits<Price>::min();
+   Journal* journal = nullptr;
+   L3Encoder* l3Encoder = nullptr;
+
+   // Declared ahead of the containers that draw from them.
+   CountingResource heapResource;
+   std::pmr::monotonic_buffer_resource arena;
+   std::pmr::unsynchronized_pool_resource pool;
+
+   // Every resting order and pending stop, by slot. The slab and the
+   // reference tables sit on heapResource rather than the arena so that
+   // when they grow, the block they leave is freed.
+   OrderSlab slab;
+
+   PriceLadder<Side::Sell> asks;
+   PriceLadder<Side::Buy> bids;
+   OrderReference orderbookReference;
+
+   // Pending stops keyed by stop price, each ladder ordered so its best
+   // level is the next to trigger: lowest stop first for buys, highest for
+   // sells. A trade only has to look at the two best levels.
+   PriceLadder<Side::Sell> buyStops;
+   PriceLadder<Side::Buy> sellStops;
+   OrderReference stopReference;
+
+   // Each owner's open orders, resting and stop alike, linked through
+   // their slots.
+   struct OwnerOrders
+   {
+      SlotIndex head = NoSlot;
+      std::size_t openOrders = 0;
+   };
+   std::pmr::unordered_map<OwnerID, OwnerOrders> owners;
+
+   // Taker volume removed by self-trade prevention while matching the
+   // current order, so its outcome does not count it as filled.
+   Volume selfTradeReduced = 0;
+   static constexpr OwnerID NoSelfTradeOwner = std::numeric_limits<OwnerID>::max();
+
+   // Scratch for a Fill-or-Kill check: the prices at which the taker's
+   // owner rests within reach, touch first. Kept to reuse its capacity.
+   mutable std::pmr::vector<Price> ownerLevels;
+
+   // Resting GoodTillDate / Day orders by expiry, and the levels an
+   // AdvanceTime or CancelByOwner has touched so each is published once.
+   TimingWheel<RestingOrderDetails, &RestingOrderDetails::expiryLink> expiries;
+   Timestamp sessionClose = 0;
+   std::pmr::vector<std::pair<Side, Price>> touchedLevels;
 
    CompletedOrders completedOrders;
+   RingBuffer<ExecutionEvent> executionEvents;
+   RingBuffer<LevelUpdate> levelUpdates;
+
+#ifdef LOB_LATENCY_STATS
+   std::unique_ptr<OrderbookLatency> latencyStats = std::make_unique<OrderbookLatency>();
+#endif
+
+   bool Journalled(const EngineCommand& command);
+   OrderOutcome ProcessOrder(Order& order);
+   static OwnerID SelfTradeOwner(const Order& taker);
+   bool CountFillableVolume(const Order& order, const PriceLevel& level, OwnerID selfTradeOwner,
+                            Volume& accumulated, bool& blocked) const;
+   void Publish(ExecutionEventType type, const Order& order, Volume quantity);
+   void Publish(ExecutionEventType type, SlotIndex slot, Volume quantity);
+   void PublishLevel(Side side, Price price, const PriceLevel& level);
+   void HandleFilledOrder(PriceLevel& level);
+   SlotIndex Reference(OrderReference& references, const Order& order);
+   OrderOutcome HandleStopOrder(Order& order);
+   bool IsStopTriggered(Side side, Price stopPrice) const;
+   OrderOutcome TriggerStop(Order& stop);
+   void ReleaseTriggeredStops();
+   bool RemoveStop(ID orderID);
+   bool RemoveOrder(ID orderID);
+   void LinkOwner(SlotIndex slot);
+   void UnlinkOwner(SlotIndex slot);
+   void ScheduleExpiry(SlotIndex slot);
 
-   Volume ConsumeOrderbookEntry(const Volume remaining, std::deque<Order>& queue);
-   void HandleFilledOrder(std::deque<Order>& queue);
+   // How the expiry wheel reaches the details it links by slot.
+   auto ExpiryNodes()
+   {
+      return [this](const SlotIndex slot) -> RestingOrderDetails& { return slab.Details(slot); };
+   }
+
+   void Unreference(OrderReference& references, OrderReference::Entry* reference);
+   void PullOrder(SlotIndex slot, ExecutionEventType type);
+   void PullStop(SlotIndex slot);
+   void PublishTouchedLevels();
+   std::size_t DropLevels(Side side, Price low, Price high);
+
+   // The matching core, instantiated once per side. ProcessOrder and
+   // ModifyOrder look at an order's side once and stay inside that side's
+   // instantiation from there, so the loops below compare against
+   // constants instead of branching on the side.
+   template <Side S>
+   PriceLadder<S>& Ladder()
+   {
+      if constexpr (S == Side::Buy)
+         return bids;
+      else
+         return asks;
+   }
+
+   template <Side S>
+   const PriceLadder<S>& Ladder() const { return const_cast<Orderbook*>(this)->Ladder<S>(); }
+
+   template <Side S>
+   OrderOutcome ProcessOrder(Order& order);
+   template <Side S>
    bool CanProcessOrder(const Order& order) const;
-   
-   // Two overloads for different map types
-   bool HasSufficientVolume(const Order& order, const std::map<double, std::deque<Order>>& bookSide) const;
-   bool HasSufficientVolume(const Order& order, const std::map<double, std::deque<Order>, std::greater<double>>& bookSide) const;
-   
-   bool HasSufficientBuyVolume(const Order& order, const std::map<double, std::deque<Order>>& asks) const;
-   bool HasSufficientSellVolume(const Order& order, const std::map<double, std::deque<Order>, std::greater<double>>& bids) const;
-   
-   OrderOutcome HandleMarketOrder( Order& order);
-   OrderOutcome HandleLimitOrder( Order& order);
-   OrderOutcome HandleFillOrKill( Order& order);
-   OrderOutcome HandleIOC( Order& order);
+   template <Side S>
+   bool HasSufficientVolume(const Order& order) const;
+   template <Side S>
+   void CollectOwnerLevels(const Order& order, OwnerID owner) const;
+
+   template <Side S>
+   OrderOutcome HandleMarketOrder(Order& order);
+   template <Side S>
+   OrderOutcome HandleLimitOrder(Order& order);
+   template <Side S>
+   OrderOutcome HandleFillOrKill(Order& order);
+   template <Side S>
+   OrderOutcome HandleIOC(Order& order);
+
+   template <Side S, bool Limited>
+   Volume Match(const Order& taker, Volume required);
+   template <Side S>
+   Volume ConsumeOrderbookEntry(const Order& taker, const Volume remaining, PriceLevel& level, Price price,
+                                OwnerID selfTradeOwner);
+   template <Side S>
+   Volume PreventSelfTrade(const Order& taker, Volume remaining, PriceLevel& level, Price price);
+
+   template <Side S>
+   void AddToBook(Order& order);
+   template <Side S>
+   bool ModifyResting(OrderReference::Entry* reference, Price newPrice, Volume newVolume);
+   template <Side S>
+   PriceLevel EraseFromLevel(PriceLadder<S>& ladder, Price price, SlotIndex slot);
 
    OrderOutcome CleanupOrder(Order& order, const Volume accumulated, const Volume required);
+
+   template <Side S>
+   std::size_t DropLevels(PriceLadder<S>& ladder, Price low, Price high);
+
+   template <Side S>
+   void LoadLevels(PriceLadder<S>& ladder, const SnapshotLevel* levels, std::uint64_t levelCount,
+                   const SnapshotOrder*& orders);
 };
 
 #endif
\ No newline at end of file
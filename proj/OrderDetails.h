@@ -1,18 +1,64 @@
+#pragma once
+
 #include <vector>
+#include <cstdint>
 
 #include "Side.h"
 
-using Price = double;
-using ID = double;
-using Volume = double;
-using Quantity = double;
+// Prices are fixed-point: an integer number of ticks. The owning Orderbook's
+// tick size converts between ticks and decimal prices at the edges.
+using Price = std::int64_t;
+using ID = std::uint64_t;
+using Volume = std::int64_t;
+using Quantity = std::int64_t;
+
+// What the matching code needs to know about a side, fixed at compile
+// time so each side gets its own branch-free instantiation.
+template <Side S>
+struct SideTraits
+{
+   static constexpr Side Opposite = (S == Side::Buy) ? Side::Sell : Side::Buy;
+
+   // Whether an order on this side limited at limit trades with a resting
+   // order at price.
+   static constexpr bool Crosses(const Price limit, const Price price)
+   {
+      if constexpr (S == Side::Buy)
+         return limit >= price;
+      else
+         return limit <= price;
+   }
+};
+
+// Points in time as a book sees them. The unit is the caller's
+// (nanoseconds, exchange ticks, ...); only the ordering matters.
+using Timestamp = std::uint64_t;
+
+// The participant (session or account) an order was entered for. 0 means
+// unattributed; the maximum value is reserved by the matching loop.
+using OwnerID = std::uint32_t;
 
-enum class OrderType
+// What happens when an incoming order would trade against a resting order
+// with the same owner. The incoming order's setting decides.
+enum class SelfTradePrevention : std::uint8_t
+{
+   None,           // trade as normal
+   CancelNewest,   // cancel the incoming order's remainder
+   CancelOldest,   // cancel the resting order and keep matching
+   CancelBoth,     // cancel both
+   Decrement       // shrink both by the smaller size without trading
+};
+
+enum class OrderType : std::uint8_t
 {
    GoodTillCancel,
    ImmediateOrCancel,
    FillOrKill,
    Market,
+   Stop,        // becomes a Market order once the last trade reaches the stop price
+   StopLimit,   // becomes a GoodTillCancel limit order once the last trade reaches the stop price
+   GoodTillDate,   // limit order that rests until its expiry time
+   Day             // limit order that rests until the book's session close
 };
 
 enum class OrderOutcome
@@ -22,10 +68,4 @@ enum class OrderOutcome
    PartiallyFilledAndAddedToBook,
    Cancelled,
    AddedToOrderbook
-};
-
-struct OrderLocation
-{
-   Price price;
-   Side side;
 };
\ No newline at end of file
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <vector>
+#include <random>
+#include <cstddef>
+#include <cstdint>
+
+#include "EngineCommand.h"
+
+// Shape of a synthetic order flow. New orders arrive in the given type mix;
+// cancels and modifies are drawn as fractions of all commands. Passive
+// prices sit a geometric number of ticks behind the touch, so most resting
+// orders land near it; aggressive orders cross it by the same kind of
+// distance. The seeded book is bookDepth levels deep on each side with
+// queueLength orders per level.
+struct OrderFlowConfig
+{
+   double goodTillCancelWeight = 0.85;
+   double immediateOrCancelWeight = 0.08;
+   double fillOrKillWeight = 0.02;
+   double marketWeight = 0.05;
+
+   double cancelRatio = 0.40;
+   double modifyRatio = 0.10;
+   double aggressiveLimitRatio = 0.10;   // GTCs that cross the touch
+
+   Price midPrice = 10000;
+   double touchDistance = 0.35;          // geometric p; smaller spreads prices wider
+
+   std::size_t bookDepth = 50;
+   std::size_t queueLength = 10;
+   Volume minVolume = 1;
+   Volume maxVolume = 100;
+
+   std::uint64_t seed = 42;
+};
+
+// Generates EngineCommands for a given flow. It remembers the orders it has
+// sent that may still be resting, and draws cancel and modify targets from
+// them; some will have traded away in the meantime, as they would in a
+// real flow, and those commands simply miss.
+class OrderFlowGenerator
+{
+public:
+   explicit OrderFlowGenerator(const OrderFlowConfig& config)
+      : config(config),
+        random(config.seed),
+        volume(config.minVolume, config.maxVolume),
+        distance(config.touchDistance),
+        typeMix({config.goodTillCancelWeight, config.immediateOrCancelWeight,
+                 config.fillOrKillWeight, config.marketWeight})
+   {}
+
+   // Commands that build the configured resting book from empty.
+   std::vector<EngineCommand> SeedBook()
+   {
+      std::vector<EngineCommand> commands;
+      commands.reserve(2 * config.bookDepth * config.queueLength);
+
+      for (std::size_t level = 0; level < config.bookDepth; ++level)
+      {
+         for (std::size_t n = 0; n < config.queueLength; ++n)
+         {
+            commands.push_back(Rest(Side::Buy, config.midPrice - 1 - static_cast<Price>(level)));
+            commands.push_back(Rest(Side::Sell, config.midPrice + 1 + static_cast<Price>(level)));
+         }
+      }
+      return commands;
+   }
+
+   // One command from the configured mix.
+   EngineCommand Next()
+   {
+      const double draw = unit(random);
+
+      if (draw < config.cancelRatio && !live.empty())
+         return NextCancel();
+      if (draw < config.cancelRatio + config.modifyRatio && !live.empty())
+         return NextModify();
+
+      static constexpr OrderType types[] = {OrderType::GoodTillCancel, OrderType::ImmediateOrCancel,
+                                            OrderType::FillOrKill, OrderType::Market};
+      return NextNew(types[typeMix(random)]);
+   }
+
+   // A new order of the given type on a random side.
+   EngineCommand NextNew(const OrderType type)
+   {
+      const Side side = (random() & 1) ? Side::Buy : Side::Sell;
+
+      if (type == OrderType::GoodTillCancel && unit(random) >= config.aggressiveLimitRatio)
+         return Rest(side, PassivePrice(side));
+
+      const Price price = (type == OrderType::Market) ? 0 : AggressivePrice(side);
+      const EngineCommand command{CommandType::New, type, side, ++lastId, price, volume(random)};
+
+      if (type == OrderType::GoodTillCancel)
+         live.push_back({command.orderId, side, price, command.volume});
+      return command;
+   }
+
+   EngineCommand NextCancel()
+   {
+      const LiveOrder order = TakeLive();
+      return {CommandType::Cancel, OrderType::GoodTillCancel, order.side, order.id, 0, 0};
+   }
+
+   // Either shrinks a live order in place or moves it to another passive price.
+   EngineCommand NextModify()
+   {
+      LiveOrder& order = live[PickLive()];
+
+      if (random() & 1)
+      {
+         order.volume = order.volume > 1 ? order.volume - 1 : 1;
+      }
+      else
+      {
+         order.price = PassivePrice(order.side);
+      }
+      return {CommandType::Modify, OrderType::GoodTillCancel, order.side, order.id, order.price, order.volume};
+   }
+
+   std::size_t GetLiveCount() const { return live.size(); }
+
+private:
+   struct LiveOrder
+   {
+      ID id;
+      Side side;
+      Price price;
+      Volume volume;
+   };
+
+   OrderFlowConfig config;
+   std::mt19937_64 random;
+   std::uniform_real_distribution<double> unit{0.0, 1.0};
+   std::uniform_int_distribution<Volume> volume;
+   std::geometric_distribution<Price> distance;
+   std::discrete_distribution<int> typeMix;
+   std::vector<LiveOrder> live;
+   ID lastId = 0;
+
+   EngineCommand Rest(const Side side, const Price price)
+   {
+      const EngineCommand command{CommandType::New, OrderType::GoodTillCancel, side, ++lastId, price, volume(random)};
+      live.push_back({command.orderId, side, price, command.volume});
+      return command;
+   }
+
+   Price PassivePrice(const Side side)
+   {
+      const Price ticks = 1 + distance(random);
+      return side == Side::Buy ? config.midPrice - ticks : config.midPrice + ticks;
+   }
+
+   Price AggressivePrice(const Side side)
+   {
+      const Price ticks = 1 + distance(random);
+      return side == Side::Buy ? config.midPrice + ticks : config.midPrice - ticks;
+   }
+
+   std::size_t PickLive()
+   {
+      return std::uniform_int_distribution<std::size_t>(0, live.size() - 1)(random);
+   }
+
+   LiveOrder TakeLive()
+   {
+      const std::size_t index = PickLive();
+      const LiveOrder order = live[index];
+      live[index] = live.back();
+      live.pop_back();
+      return order;
+   }
+};
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+#include "OrderSlab.h"
+
+// Client order ID to slot, as an open-addressing table with linear
+// probing. Entries sit inline in one array sized up front, so an insert
+// does not allocate and a lookup usually reads a single cache line. An
+// erase shifts the rest of its probe run back over the gap rather than
+// leaving a tombstone, so probe lengths depend only on the live entries
+// however long the book churns. The table doubles once it is three
+// quarters full.
+class OrderIndex
+{
+public:
+   struct Entry
+   {
+      ID id;
+      SlotIndex slot;   // NoSlot marks an empty bucket
+   };
+
+   explicit OrderIndex(std::size_t capacity = 4096,
+                       std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : entries(resource)
+   {
+      Reserve(capacity);
+   }
+
+   bool empty() const { return count == 0; }
+   std::size_t size() const { return count; }
+
+   // Sizes the table so that expected entries fit without it growing.
+   void Reserve(const std::size_t expected)
+   {
+      const std::size_t buckets = std::bit_ceil(std::max<std::size_t>(expected + expected / 3 + 1, 16));
+      if (buckets > entries.size())
+         Rehash(buckets);
+   }
+
+   Entry* Find(const ID id)
+   {
+      for (std::size_t index = Home(id); ; index = Next(index))
+      {
+         Entry& entry = entries[index];
+         if (entry.slot == NoSlot)
+            return nullptr;
+         if (entry.id == id)
+            return &entry;
+      }
+   }
+
+   const Entry* Find(const ID id) const
+   {
+      return const_cast<OrderIndex*>(this)->Find(id);
+   }
+
+   // Maps id to slot. An id that is already mapped keeps its slot and
+   // Insert returns false.
+   bool Insert(const ID id, const SlotIndex slot)
+   {
+      if ((count + 1) * 4 > entries.size() * 3)
+         Rehash(entries.size() * 2);
+
+      std::size_t index = Home(id);
+      for (; entries[index].slot != NoSlot; index = Next(index))
+      {
+         if (entries[index].id == id)
+            return false;
+      }
+
+      entries[index] = {id, slot};
+      ++count;
+      return true;
+   }
+
+   // Removes an entry returned by Find. Later entries of the same probe
+   // run move up into the gap, so pointers to them do not survive.
+   void Erase(Entry* entry)
+   {
+      std::size_t hole = static_cast<std::size_t>(entry - entries.data());
+
+      for (std::size_t index = Next(hole); entries[index].slot != NoSlot; index = Next(index))
+      {
+         // An entry may fill the hole only if the hole lies between its
+         // home bucket and where it sits now.
+         const std::size_t home = Home(entries[index].id);
+         if (((index - home) & mask) >= ((index - hole) & mask))
+         {
+            entries[hole] = entries[index];
+            hole = index;
+         }
+      }
+
+      entries[hole].slot = NoSlot;
+      --count;
+   }
+
+private:
+   std::pmr::vector<Entry> entries;
+   std::size_t mask = 0;
+   unsigned shift = 0;
+   std::size_t count = 0;
+
+   // Fibonacci hashing: the multiply spreads sequential and strided IDs,
+   // and the top bits pick the bucket.
+   std::size_t Home(const ID id) const
+   {
+      return static_cast<std::size_t>((id * 0x9E3779B97F4A7C15ull) >> shift);
+   }
+
+   std::size_t Next(const std::size_t index) const { return (index + 1) & mask; }
+
+   void Rehash(const std::size_t buckets)
+   {
+      std::pmr::vector<Entry> old(buckets, Entry{0, NoSlot}, entries.get_allocator());
+      old.swap(entries);
+      mask = buckets - 1;
+      shift = static_cast<unsigned>(64 - std::countr_zero(buckets));
+      count = 0;
+
+      for (const Entry& entry : old)
+      {
+         if (entry.slot != NoSlot)
+            (void)Insert(entry.id, entry.slot);
+      }
+   }
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <vector>
+
+#include "Order.h"
+#include "TimingWheel.h"
+
+// The book's internal ID for a resting order or pending stop: the index of
+// its slot in the OrderSlab. Levels, owner lists and the expiry wheel all
+// refer to orders by slot, so inside the book an order is found by array
+// index; client IDs are translated once, at the API boundary.
+using SlotIndex = std::uint32_t;
+inline constexpr SlotIndex NoSlot = std::numeric_limits<SlotIndex>::max();
+
+// The part of a resting order the matching loop reads. Price and side are
+// the level's, so they are not repeated here; two records share a cache
+// line.
+struct RestingOrder
+{
+   ID id;
+   Volume remaining;
+   OwnerID owner;
+   SlotIndex next;       // FIFO neighbours at the order's level, NoSlot at either end
+   SlotIndex previous;
+};
+
+static_assert(sizeof(RestingOrder) <= 32, "resting orders must stay two to a cache line");
+
+// Everything else about a resting order, read only when it enters or
+// leaves the book. The expiry wheel links details by slot, so they may
+// move when the slab grows.
+struct RestingOrderDetails
+{
+   Price price;
+   Price stopPrice;
+   Volume initialVolume;
+   Timestamp expiry;
+   OrderType type;
+   Side side;
+   SelfTradePrevention selfTradePrevention;
+   SlotIndex slot;
+   SlotIndex ownerPrev;  // the owner's other open orders
+   SlotIndex ownerNext;
+   TimerLink expiryLink{};
+};
+
+// Dense storage for resting orders and pending stops. Freed slots are
+// reused most recently freed first, so slot numbers stay packed at the
+// low end and the records the book touches stay warm. Both arrays are
+// reserved for capacity orders up front, so filling the slab that far
+// does not allocate.
+class OrderSlab
+{
+public:
+   explicit OrderSlab(std::size_t capacity = 4096,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : orders(resource),
+        details(resource)
+   {
+      orders.reserve(capacity);
+      details.reserve(capacity);
+   }
+
+   std::size_t size() const { return live; }
+
+   RestingOrder& operator[](const SlotIndex slot) { return orders[slot]; }
+   const RestingOrder& operator[](const SlotIndex slot) const { return orders[slot]; }
+
+   RestingOrderDetails& Details(const SlotIndex slot) { return details[slot]; }
+   const RestingOrderDetails& Details(const SlotIndex slot) const { return details[slot]; }
+
+   // Files order in a free slot, unlinked from any level or owner.
+   SlotIndex Allocate(const Order& order)
+   {
+      SlotIndex slot = freeHead;
+
+      if (slot != NoSlot)
+      {
+         freeHead = orders[slot].next;
+      }
+      else
+      {
+         slot = static_cast<SlotIndex>(orders.size());
+         orders.emplace_back();
+         details.emplace_back();
+      }
+
+      orders[slot] = {order.GetId(), order.GetRemainingVolume(), order.GetOwner(), NoSlot, NoSlot};
+
+      RestingOrderDetails& detail = details[slot];
+      detail.price = order.GetPrice();
+      detail.stopPrice = order.GetStopPrice();
+      detail.initialVolume = order.GetInitialVolume();
+      detail.expiry = order.GetExpiry();
+      detail.type = order.GetType();
+      detail.side = order.GetSide();
+      detail.selfTradePrevention = order.GetSelfTradePrevention();
+      detail.slot = slot;
+      detail.ownerPrev = detail.ownerNext = NoSlot;
+
+      ++live;
+      return slot;
+   }
+
+   // Returns a slot whose order has left the book; the caller must already
+   // have unlinked it from its level, owner list and the expiry wheel.
+   void Release(const SlotIndex slot)
+   {
+      orders[slot].next = freeHead;
+      freeHead = slot;
+      --live;
+   }
+
+   // Reassembles the full order held in a slot.
+   Order ToOrder(const SlotIndex slot) const
+   {
+      const RestingOrder& order = orders[slot];
+      const RestingOrderDetails& detail = details[slot];
+
+      Order assembled(detail.type, order.id, detail.price, detail.side, detail.initialVolume, detail.stopPrice);
+      assembled.SetRemainingVolume(order.remaining);
+      assembled.SetOwner(order.owner);
+      assembled.SetSelfTradePrevention(detail.selfTradePrevention);
+      assembled.SetExpiry(detail.expiry);
+      return assembled;
+   }
+
+private:
+   std::pmr::vector<RestingOrder> orders;
+   std::pmr::vector<RestingOrderDetails> details;
+   SlotIndex freeHead = NoSlot;   // free slots, chained through next
+   std::size_t live = 0;
+};
@@ -1,90 +1,244 @@
 #include "OrderBook.h"
+#include "Journal.h"
+#include "L3Feed.h"
 
-ID Orderbook::nextOrderID = 0;
+#include <algorithm>
+#include <functional>
+#include <limits>
 
-// Description: Main entry point for processing orders, validates and 
-// routes to appropriate handler based on order type.
+// Description: Rough arena size for a book of the given capacity: the
+// level windows for both sides and both stop ladders, and the retained
+// completed orders. The slab and reference tables are not in it: they
+// can grow, and a block handed back to the arena is never reused, so
+// they draw on the heap directly.
+static std::size_t ArenaBytes(const OrderbookCapacity& capacity)
+{
+   return 2 * (capacity.priceLevels + capacity.stopLevels) * sizeof(PriceLevel)
+        + capacity.completedOrders * sizeof(Order);
+}
+
+Orderbook::Orderbook(const double tickSize, const OrderbookCapacity& capacity)
+   :
+   tickSize(tickSize),
+   arena(ArenaBytes(capacity), &heapResource),
+   pool(std::pmr::pool_options{capacity.maxOrders, 0}, &arena),
+   slab(capacity.maxOrders, &heapResource),
+   asks(capacity.priceLevels, &pool),
+   bids(capacity.priceLevels, &pool),
+   orderbookReference(capacity.maxOrders, &heapResource),
+   buyStops(capacity.stopLevels, &pool),
+   sellStops(capacity.stopLevels, &pool),
+   stopReference(capacity.stopLevels, &heapResource),
+   owners(&pool),
+   ownerLevels(&pool),
+   touchedLevels(&pool),
+   completedOrders(capacity.completedOrders, &pool),
+   executionEvents(capacity.executionEvents),
+   levelUpdates(capacity.levelUpdates)
+{}
+
+// Description: Main entry point for processing orders. Gives a Day order
+// its expiry, journals the order and, if the journal took it, processes
+// it and fires any stops its fills crossed; the whole call is timed when
+// latency stats are built in.
 OrderOutcome Orderbook::ExecuteTrade(Order& order)
 {
-   if ( !CanProcessOrder(order) )
+#ifdef LOB_LATENCY_STATS
+   const std::uint64_t start = ReadTsc();
+   const OrderType type = order.GetType();
+#endif
+
+   if (order.GetType() == OrderType::Day && order.GetExpiry() == 0)
+      order.SetExpiry(sessionClose);
+
+   OrderOutcome outcome = OrderOutcome::Cancelled;
+
+   if (Journalled({CommandType::New, order.GetType(), order.GetSide(), order.GetId(),
+                   order.GetPrice(), order.GetInitialVolume(), order.GetStopPrice(), order.GetOwner(),
+                   order.GetSelfTradePrevention(), order.GetExpiry()}))
+   {
+      outcome = ProcessOrder(order);
+      ReleaseTriggeredStops();
+   }
+
+#ifdef LOB_LATENCY_STATS
+   latencyStats->ExecuteTrade(type, outcome).Record(ReadTsc() - start);
+#endif
+   return outcome;
+}
+
+// Description: Writes a command to the attached journal ahead of
+// applying it. A command the journal cannot take is refused with a
+// Rejected report before it touches the book, so a replay of the journal
+// always rebuilds the book as it is.
+bool Orderbook::Journalled(const EngineCommand& command)
+{
+   if (!journal || journal->Append(command))
+      return true;
+
+   executionEvents.Push({ExecutionEventType::Rejected, command.side, command.orderId, 0,
+                         command.price, command.volume, 0});
+   return false;
+}
+
+// Description: Settles the order's side once; validation, matching and
+// resting all run in that side's instantiation from here on.
+OrderOutcome Orderbook::ProcessOrder(Order& order)
+{
+   if (order.GetSide() == Side::Buy)
+      return ProcessOrder<Side::Buy>(order);
+   return ProcessOrder<Side::Sell>(order);
+}
+
+// Description: Validates an order and routes it to the appropriate
+// handler based on order type. An order whose ID is still live, resting
+// or as a pending stop, is refused with a Rejected report and filed
+// nowhere, so nothing about it reads as the live order leaving the book.
+template <Side S>
+OrderOutcome Orderbook::ProcessOrder(Order& order)
+{
+   if (orderbookReference.Find(order.GetId()) || stopReference.Find(order.GetId()))
+   {
+      Publish(ExecutionEventType::Rejected, order, order.GetInitialVolume());
+      return OrderOutcome::Cancelled;
+   }
+
+   if ( !CanProcessOrder<S>(order) )
    {
+       Publish(ExecutionEventType::Cancelled, order, order.GetInitialVolume());
        completedOrders.Add(std::move(order));
        return OrderOutcome::Cancelled;
    }
 
+   Publish(ExecutionEventType::Accepted, order, order.GetInitialVolume());
+   selfTradeReduced = 0;
+
    switch (order.GetType())
    {
       case OrderType::Market:
-         return HandleMarketOrder(order);
+         return HandleMarketOrder<S>(order);
 
       case OrderType::FillOrKill:
-         return HandleFillOrKill(order);
+         return HandleFillOrKill<S>(order);
 
       case OrderType::ImmediateOrCancel:
-         return HandleIOC(order);
+         return HandleIOC<S>(order);
 
       case OrderType::GoodTillCancel:
-         return HandleLimitOrder(order);
+      case OrderType::GoodTillDate:
+      case OrderType::Day:
+         return HandleLimitOrder<S>(order);
+
+      case OrderType::Stop:
+      case OrderType::StopLimit:
+         return HandleStopOrder(order);
 
       default:
          return OrderOutcome::Cancelled;
    }
 }
 
-// Description: Modifies an existing resting order's price and volume, 
-// maintaining price-time priority on volume decrease.
+// Description: Modifies a resting order. A volume cut at the same price
+// is applied in place and keeps queue priority; anything else is a
+// cancel-replace that sends the order to the back of its new level, or,
+// when the new price crosses the opposite touch, through matching like a
+// fresh limit order under the same ID.
 bool Orderbook::ModifyOrder(const ID orderID, const Price newPrice, const Volume newVolume)
 {
+#ifdef LOB_LATENCY_STATS
+   const ScopedLatency timer(latencyStats->modifyOrder);
+#endif
+
+   if (!Journalled({CommandType::Modify, OrderType::GoodTillCancel, Side::Buy, orderID, newPrice, newVolume}))
+      return false;
+
    if (newVolume <= 0)
    {
-      return CancelOrder(orderID);
+      return RemoveOrder(orderID);
    }
 
-   auto refIt = orderbookReference.find(orderID);
+   OrderReference::Entry* reference = orderbookReference.Find(orderID);
 
-   if (refIt == orderbookReference.end())
+   if (!reference)
       return false;
 
-   const Price oldPrice = refIt->second.price;
-   const Side side = refIt->second.side;
+   if (slab.Details(reference->slot).side == Side::Buy)
+      return ModifyResting<Side::Buy>(reference, newPrice, newVolume);
+   return ModifyResting<Side::Sell>(reference, newPrice, newVolume);
+}
 
-   if ( side == Side::Buy )
+// Description: Applies a modify to a resting order on side S. The
+// order's level is resolved once.
+template <Side S>
+bool Orderbook::ModifyResting(OrderReference::Entry* const reference, const Price newPrice, const Volume newVolume)
+{
+   using Traits = SideTraits<S>;
+   PriceLadder<S>& ladder = Ladder<S>();
+   const PriceLadder<Traits::Opposite>& opposite = Ladder<Traits::Opposite>();
+
+   const SlotIndex slot = reference->slot;
+   RestingOrder& order = slab[slot];
+   RestingOrderDetails& details = slab.Details(slot);
+   const ID orderID = order.id;
+   const Price oldPrice = details.price;
+   const Volume oldVolume = order.remaining;
+   PriceLevel& level = *ladder.Find(oldPrice);
+
+   if (newPrice == oldPrice && newVolume <= oldVolume)
    {
-      for (auto it = bids[oldPrice].begin(); it != bids[oldPrice].end(); ++it)
+      if (newVolume != oldVolume)
       {
-         if ( it->GetId() == orderID )
-         {
-            ModifyVolume( *it, newVolume);
-         
-            if (oldPrice != newPrice)
-            {
-               bids[newPrice].push_back(std::move(*it));
-               (void)bids[oldPrice].erase(it);
-               refIt->second.price = newPrice;
-            }
-            break;
-         }
+         order.remaining = newVolume;
+         level.ReduceVolume(oldVolume - newVolume);
+         if (l3Encoder)
+            l3Encoder->Cancel(orderID, S, oldPrice, oldVolume - newVolume);
+         PublishLevel(S, oldPrice, level);
       }
+      Publish(ExecutionEventType::Modified, slot, newVolume);
+      return true;
    }
-   else
+
+   const bool marketable = !opposite.empty() && Traits::Crosses(newPrice, opposite.BestPrice());
+
+   // The replacement takes over the slot, so its reference entry, owner
+   // link and expiry stay as they are. A requeue at the same price leaves
+   // the level briefly empty but still claimed in the ladder, and refills
+   // it straight away.
+   level.Erase(slab, slot);
+   order.remaining = newVolume;
+   details.price = newPrice;
+   details.initialVolume = newVolume;
+
+   if (newPrice != oldPrice)
    {
-      for (auto it = asks[oldPrice].begin(); it != asks[oldPrice].end(); ++it)
-      {
-         if ( it->GetId() == orderID )
-         {
-            ModifyVolume( *it, newVolume);
-         
-            if (oldPrice != newPrice)
-            {
-               asks[newPrice].push_back(std::move(*it));
-               (void)asks[oldPrice].erase(it);
-               refIt->second.price = newPrice;
-            }
-            break;
-         }
-      }
+      PublishLevel(S, oldPrice, level);
+      if (level.empty())
+         ladder.Erase(oldPrice);
    }
 
+   if (marketable)
+   {
+      if (l3Encoder)
+         l3Encoder->Delete(orderID, S, oldPrice);
+
+      Order replacement = slab.ToOrder(slot);
+      Unreference(orderbookReference, reference);
+
+      Publish(ExecutionEventType::Modified, replacement, newVolume);
+      selfTradeReduced = 0;
+      (void)HandleLimitOrder<S>(replacement);
+      ReleaseTriggeredStops();
+      return true;
+   }
+
+   PriceLevel& target = (newPrice == oldPrice) ? level : ladder[newPrice];
+   target.Append(slab, slot);
+   PublishLevel(S, newPrice, target);
+
+   if (l3Encoder)
+      l3Encoder->Replace(orderID, S, newPrice, newVolume);
+
+   Publish(ExecutionEventType::Modified, slot, newVolume);
    return true;
 }
 
@@ -106,46 +260,361 @@ bool Orderbook::ModifyVolume(Order& order, const Volume newVolume)
    return true;
 }
 
-// Description: Removes an order from the orderbook and reference map.
+// Description: Journals and applies a cancel request.
 bool Orderbook::CancelOrder(const ID orderID)
 {
-   auto refIt = orderbookReference.find(orderID);
+#ifdef LOB_LATENCY_STATS
+   const ScopedLatency timer(latencyStats->cancelOrder);
+#endif
 
-   if (refIt == orderbookReference.end())
+   if (!Journalled({CommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, orderID, 0, 0}))
       return false;
 
-   const Price price = refIt->second.price;
-   const Side side = refIt->second.side;
+   return RemoveOrder(orderID);
+}
+
+// Description: Journals and applies a cancel of one whole side.
+std::size_t Orderbook::CancelAll(const Side side)
+{
+   if (!Journalled({CommandType::CancelAll, OrderType::GoodTillCancel, side, 0, 0, 0}))
+      return 0;
+
+   return DropLevels(side, std::numeric_limits<Price>::min(), std::numeric_limits<Price>::max());
+}
+
+// Description: Journals and applies a cancel of every level on one side
+// priced within [low, high].
+std::size_t Orderbook::CancelRange(const Side side, const Price low, const Price high)
+{
+   if (!Journalled({CommandType::CancelRange, OrderType::GoodTillCancel, side, 0, low, 0, high}))
+      return 0;
+
+   return DropLevels(side, low, high);
+}
+
+// Description: Journals and applies a cancel of every resting order and
+// pending stop entered for owner, e.g. when its session disconnects. The
+// owner's list leads straight to its orders' slots, so the cost is
+// proportional to what it has open rather than to the size of the book.
+// Each resting level touched gets one LevelUpdate, published at the end.
+std::size_t Orderbook::CancelByOwner(const OwnerID owner)
+{
+   if (!Journalled({CommandType::CancelByOwner, OrderType::GoodTillCancel, Side::Buy, 0, 0, 0, 0, owner}))
+      return 0;
+
+   auto ownerIt = owners.find(owner);
+   if (ownerIt == owners.end())
+      return 0;
 
-   if ( side == Side::Buy )
+   std::size_t cancelled = 0;
+   touchedLevels.clear();
+   for (SlotIndex slot = ownerIt->second.head; slot != NoSlot; ++cancelled)
    {
-      for (auto it = bids[price].begin(); it != bids[price].end(); ++it)
-      {
-         if ( it->GetId() == orderID )
-         {
-            orderbookReference.erase(refIt);
-            (void)bids[price].erase(it);
-            break;
-         }
-      }
+      // Removal releases this slot and may drop the owner's record, so
+      // step past it first.
+      const RestingOrderDetails& details = slab.Details(slot);
+      const SlotIndex next = details.ownerNext;
+      if (details.type == OrderType::Stop || details.type == OrderType::StopLimit)
+         PullStop(slot);
+      else
+         PullOrder(slot, ExecutionEventType::Cancelled);
+      slot = next;
    }
+
+   PublishTouchedLevels();
+   return cancelled;
+}
+
+// Description: Number of resting orders and pending stops owner has open.
+std::size_t Orderbook::GetOpenOrderCount(const OwnerID owner) const
+{
+   auto ownerIt = owners.find(owner);
+   return ownerIt == owners.end() ? 0 : ownerIt->second.openOrders;
+}
+
+// Description: Pushes a newly referenced order onto the front of its
+// owner's list. Unattributed orders are not tracked.
+void Orderbook::LinkOwner(const SlotIndex slot)
+{
+   const OwnerID owner = slab[slot].owner;
+   if (owner == 0)
+      return;
+
+   OwnerOrders& orders = owners[owner];
+   RestingOrderDetails& details = slab.Details(slot);
+   details.ownerPrev = NoSlot;
+   details.ownerNext = orders.head;
+   if (orders.head != NoSlot)
+      slab.Details(orders.head).ownerPrev = slot;
+   orders.head = slot;
+   ++orders.openOrders;
+}
+
+// Description: Takes an order off its owner's list before its slot is
+// released, forgetting the owner once nothing is left open.
+void Orderbook::UnlinkOwner(const SlotIndex slot)
+{
+   const OwnerID owner = slab[slot].owner;
+   if (owner == 0)
+      return;
+
+   auto ownerIt = owners.find(owner);
+   OwnerOrders& orders = ownerIt->second;
+   const RestingOrderDetails& details = slab.Details(slot);
+
+   if (details.ownerPrev != NoSlot)
+      slab.Details(details.ownerPrev).ownerNext = details.ownerNext;
    else
+      orders.head = details.ownerNext;
+   if (details.ownerNext != NoSlot)
+      slab.Details(details.ownerNext).ownerPrev = details.ownerPrev;
+
+   if (--orders.openOrders == 0)
+      owners.erase(ownerIt);
+}
+
+// Description: Removes every resting level on one side within [low, high].
+std::size_t Orderbook::DropLevels(const Side side, const Price low, const Price high)
+{
+   return (side == Side::Buy) ? DropLevels(bids, low, high) : DropLevels(asks, low, high);
+}
+
+// Description: Reports and unindexes each order on the levels in range,
+// then clears every level in one go. Nothing is searched per order: the
+// ladder hands over the levels and the orders are read off in place.
+template <Side S>
+std::size_t Orderbook::DropLevels(PriceLadder<S>& ladder, const Price low, const Price high)
+{
+   std::size_t cancelled = 0;
+
+   ladder.EraseRange(low, high, [this, &cancelled](const Price price, PriceLevel& level)
    {
-      for (auto it = asks[price].begin(); it != asks[price].end(); ++it)
+      level.ForEach(slab, [this, price](const SlotIndex slot)
       {
-         if ( it->GetId() == orderID )
-         {
-            orderbookReference.erase(refIt);
-            (void)asks[price].erase(it);
-            break;
-         }
-      }
+         const ID id = slab[slot].id;
+         Publish(ExecutionEventType::Cancelled, slot, slab[slot].remaining);
+         if (l3Encoder)
+            l3Encoder->Delete(id, S, price);
+
+         Unreference(orderbookReference, orderbookReference.Find(id));
+         return true;
+      });
+
+      cancelled += level.GetOrderCount();
+      level.Clear();
+      PublishLevel(S, price, level);
+   });
+
+   return cancelled;
+}
+
+// Description: Puts a newly referenced GoodTillDate or Day order on the
+// expiry wheel.
+void Orderbook::ScheduleExpiry(const SlotIndex slot)
+{
+   RestingOrderDetails& details = slab.Details(slot);
+   if (details.type == OrderType::GoodTillDate || details.type == OrderType::Day)
+      expiries.Schedule(ExpiryNodes(), slot, details.expiry);
+}
+
+// Description: Files an order in a fresh slot, indexes it under its
+// client ID and links it to its owner. Returns NoSlot, filing nothing,
+// if the ID is already indexed. New orders are screened for that in
+// CanProcessOrder and snapshots before loading, so no caller sees it.
+SlotIndex Orderbook::Reference(OrderReference& references, const Order& order)
+{
+   const SlotIndex slot = slab.Allocate(order);
+   if (!references.Insert(order.GetId(), slot))
+   {
+      slab.Release(slot);
+      return NoSlot;
+   }
+   LinkOwner(slot);
+   return slot;
+}
+
+// Description: Erases a reference entry once its order has left the book
+// or the stop index, detaching it from its owner's list and the expiry
+// wheel and freeing its slot.
+void Orderbook::Unreference(OrderReference& references, OrderReference::Entry* const reference)
+{
+   const SlotIndex slot = reference->slot;
+   UnlinkOwner(slot);
+   expiries.Cancel(ExpiryNodes(), slot);
+   references.Erase(reference);
+   slab.Release(slot);
+}
+
+// Description: Journals a clock move and expires the resting orders it
+// passes. Emptied levels are released as they go; the level updates are
+// held back and published once per level at the end.
+std::size_t Orderbook::AdvanceTime(const Timestamp now)
+{
+   if (!Journalled({CommandType::AdvanceTime, OrderType::GoodTillCancel, Side::Buy, 0, 0, 0, 0, 0,
+                    SelfTradePrevention::None, now}))
+   {
+      return 0;
+   }
+
+   std::size_t expired = 0;
+   touchedLevels.clear();
+   expiries.Advance(ExpiryNodes(), now, [this, &expired](RestingOrderDetails& details)
+   {
+      PullOrder(details.slot, ExecutionEventType::Expired);
+      ++expired;
+   });
+
+   PublishTouchedLevels();
+   return expired;
+}
+
+// Description: Takes one resting order off its level, reporting it as
+// type, and notes the level for PublishTouchedLevels. Expiries arrive
+// here from the expiry wheel, which has already unscheduled them.
+void Orderbook::PullOrder(const SlotIndex slot, const ExecutionEventType type)
+{
+   const RestingOrderDetails& details = slab.Details(slot);
+   const ID id = slab[slot].id;
+   const Side side = details.side;
+   const Price price = details.price;
+
+   Publish(type, slot, slab[slot].remaining);
+   if (l3Encoder)
+      l3Encoder->Delete(id, side, price);
+
+   if (side == Side::Buy)
+      EraseFromLevel(bids, price, slot);
+   else
+      EraseFromLevel(asks, price, slot);
+
+   touchedLevels.emplace_back(side, price);
+   Unreference(orderbookReference, orderbookReference.Find(id));
+}
+
+// Description: Takes one pending stop off its trigger level. Stops are
+// not on the L2 feed, so nothing is noted for publishing.
+void Orderbook::PullStop(const SlotIndex slot)
+{
+   const RestingOrderDetails& details = slab.Details(slot);
+   const ID id = slab[slot].id;
+   const Price stopPrice = details.stopPrice;
+
+   Publish(ExecutionEventType::Cancelled, slot, slab[slot].remaining);
+
+   if (details.side == Side::Buy)
+      EraseFromLevel(buyStops, stopPrice, slot);
+   else
+      EraseFromLevel(sellStops, stopPrice, slot);
+
+   Unreference(stopReference, stopReference.Find(id));
+}
+
+// Description: Publishes one LevelUpdate for each distinct level noted in
+// touchedLevels, with its aggregate as the command left it.
+void Orderbook::PublishTouchedLevels()
+{
+   std::sort(touchedLevels.begin(), touchedLevels.end());
+   touchedLevels.erase(std::unique(touchedLevels.begin(), touchedLevels.end()), touchedLevels.end());
+   for (const auto& [side, price] : touchedLevels)
+   {
+      const PriceLevel* level = (side == Side::Buy) ? bids.Find(price) : asks.Find(price);
+      if (level)
+         PublishLevel(side, price, *level);
+      else
+         levelUpdates.Push({side, price, 0, 0});
    }
+}
+
+// Description: Unlinks a slot from the level at price, releasing the
+// level from the ladder if that empties it. Returns a copy of the level
+// as it was left, for publishing once the ladder has moved on.
+template <Side S>
+PriceLevel Orderbook::EraseFromLevel(PriceLadder<S>& ladder, const Price price, const SlotIndex slot)
+{
+   PriceLevel& level = *ladder.Find(price);
+   level.Erase(slab, slot);
+   const PriceLevel left = level;
+   if (left.empty())
+      ladder.Erase(price);
+   return left;
+}
+
+// Description: Removes an order from the orderbook and reference map, or
+// a pending stop from the trigger index.
+bool Orderbook::RemoveOrder(const ID orderID)
+{
+   OrderReference::Entry* reference = orderbookReference.Find(orderID);
+
+   if (!reference)
+      return RemoveStop(orderID);
+
+   const SlotIndex slot = reference->slot;
+   const RestingOrderDetails& details = slab.Details(slot);
+   const Price price = details.price;
+   Publish(ExecutionEventType::Cancelled, slot, slab[slot].remaining);
+
+   if (l3Encoder)
+      l3Encoder->Delete(orderID, details.side, price);
+
+   if (details.side == Side::Buy)
+      PublishLevel(Side::Buy, price, EraseFromLevel(bids, price, slot));
+   else
+      PublishLevel(Side::Sell, price, EraseFromLevel(asks, price, slot));
+
+   Unreference(orderbookReference, reference);
    return true;
 }
 
+// Description: Looks a resting order up through the reference map and
+// reassembles it from its slot.
+std::optional<Order> Orderbook::FindOrder(const ID orderID) const
+{
+   const OrderReference::Entry* reference = orderbookReference.Find(orderID);
+   if (!reference)
+      return std::nullopt;
+   return slab.ToOrder(reference->slot);
+}
+
+// Description: Returns the cached total resting volume at a price level.
+Volume Orderbook::GetVolumeAtPrice(const Side side, const Price price) const
+{
+   const PriceLevel* level = (side == Side::Buy) ? bids.Find(price) : asks.Find(price);
+   return level ? level->GetTotalVolume() : 0;
+}
+
+// Description: Returns the cached number of resting orders at a price level.
+std::size_t Orderbook::GetOrderCountAtPrice(const Side side, const Price price) const
+{
+   const PriceLevel* level = (side == Side::Buy) ? bids.Find(price) : asks.Find(price);
+   return level ? level->GetOrderCount() : 0;
+}
+
+// Description: Walks one side from the touch, copying each level's cached
+// totals; the orders themselves are never visited.
+std::vector<DepthLevel> Orderbook::GetDepth(const Side side, const std::size_t levels) const
+{
+   std::vector<DepthLevel> depth;
+   depth.reserve(std::min(levels, (side == Side::Buy) ? bids.LevelCount() : asks.LevelCount()));
+
+   auto collect = [&depth, levels](const Price price, const PriceLevel& level)
+   {
+      if (depth.size() == levels)
+         return false;
+      depth.push_back({price, level.GetTotalVolume(), level.GetOrderCount()});
+      return true;
+   };
+
+   if (side == Side::Buy)
+      bids.ForEachLevel(collect);
+   else
+      asks.ForEachLevel(collect);
+
+   return depth;
+}
+
 // Description: Finalizes order processing by updating remaining volume 
-// and moving to completed orders list.
+// and moving to completed orders list. An order that lost volume to
+// self-trade prevention is never reported as fully filled.
 OrderOutcome Orderbook::CleanupOrder(Order& order, const Volume accumulated, const Volume required)
 {
    if (accumulated >= required)
@@ -157,323 +626,518 @@ OrderOutcome Orderbook::CleanupOrder(Order& order, const Volume accumulated, con
       order.SetRemainingVolume(required - accumulated);
    }
 
-   if (order.GetRemainingVolume() == 0)
+   if (order.GetRemainingVolume() == 0 && selfTradeReduced == 0)
    {
       completedOrders.Add(std::move(order));
       return OrderOutcome::FullyFilled;
    }
    else
    {
+      // Volume taken away by self-trade prevention was reported as it
+      // happened; only what was never reached is cancelled here.
+      if (order.GetRemainingVolume() != 0)
+         Publish(ExecutionEventType::Cancelled, order, order.GetRemainingVolume());
       completedOrders.Add(std::move(order));
-      return OrderOutcome::PartiallyFilledAndCancelled;
+      return (accumulated > selfTradeReduced) ? OrderOutcome::PartiallyFilledAndCancelled : OrderOutcome::Cancelled;
    }
 }
 
-// Description: Removes fully filled order from queue, updates reference 
+// Description: Removes fully filled order from its level, updates reference 
 // map, and adds to completed orders.
-void Orderbook::HandleFilledOrder(std::deque<Order>& queue)
+void Orderbook::HandleFilledOrder(PriceLevel& level)
 {
-   Order order = std::move(queue.front());
-   orderbookReference.erase(order.GetId());
+   const SlotIndex slot = level.PopFront(slab);
+   Order order = slab.ToOrder(slot);
+   Unreference(orderbookReference, orderbookReference.Find(order.GetId()));
 
    order.SetRemainingVolume(0);
    completedOrders.Add(std::move(order));
-   queue.pop_front();   
 }
 
-// Description: Executes market order by consuming liquidity across all 
-// available price levels until filled or exhausted.
-OrderOutcome Orderbook::HandleMarketOrder(Order& order)
+// Description: The matching loop every order type shares. Walks the
+// opposite side from the touch, FIFO within each level, until required
+// is used up or the book runs out; a Limited taker also stops at the
+// first level its limit price does not cross. Returns the volume used
+// up, counting self-trade reductions like fills.
+template <Side S, bool Limited>
+Volume Orderbook::Match(const Order& taker, const Volume required)
 {
-   const Volume required = order.GetInitialVolume();
+   using Traits = SideTraits<S>;
+   PriceLadder<Traits::Opposite>& book = Ladder<Traits::Opposite>();
+   const Price limit = taker.GetPrice();
+   const OwnerID selfTradeOwner = SelfTradeOwner(taker);
    Volume accumulated = 0;
-   const Side orderSide = order.GetSide();
-   Volume remaining = 0;
-   
-   if (orderSide == Side::Buy)
-   {
-      auto it = asks.begin();
 
-      while (!asks.empty() && accumulated < required) 
+   while (accumulated < required && !book.empty())
+   {
+      const Price price = book.BestPrice();
+      if constexpr (Limited)
       {
-         auto& queue = it->second;
-
-         while (!queue.empty() && accumulated < required) 
-         {
-            remaining = required - accumulated;
-            accumulated += ConsumeOrderbookEntry(remaining, queue);
-         }
-   
-         if (queue.empty())
-            it = asks.erase(it);
+         if (!Traits::Crosses(limit, price))
+            break;
       }
-   }
-   else
-   {
-      auto it = bids.begin();
-      while (!bids.empty() && accumulated < required)
+
+      PriceLevel& level = book.Best();
+      while (accumulated < required && !level.empty())
       {
-         auto& queue = it->second;
-
-         while (!queue.empty() && accumulated < required) 
-         {
-            remaining = required - accumulated;
-            accumulated += ConsumeOrderbookEntry(remaining, queue);
-         }
-         if (queue.empty())
-            it = bids.erase(it);
-      }  
+         const Volume remaining = required - accumulated;
+         accumulated += ConsumeOrderbookEntry<S>(taker, remaining, level, price, selfTradeOwner);
+      }
+      if (level.empty())
+         book.PopBest();
    }
-   
-   return CleanupOrder(order, accumulated, required);
+   return accumulated;
+}
+
+// Description: Executes market order by consuming liquidity across all 
+// available price levels until filled or exhausted.
+template <Side S>
+OrderOutcome Orderbook::HandleMarketOrder(Order& order)
+{
+   const Volume required = order.GetInitialVolume();
+   return CleanupOrder(order, Match<S, false>(order, required), required);
 }
 
 // Description: Executes Fill-or-Kill order atomically after validation 
 // confirms sufficient volume exists.
+template <Side S>
 OrderOutcome Orderbook::HandleFillOrKill(Order& order)
 {
-   return HandleMarketOrder(order);
+   return HandleMarketOrder<S>(order);
 }
 
 // Description: Executes Immediate-or-Cancel order up to the limit price,
 // cancelling any unfilled portion.
+template <Side S>
 OrderOutcome Orderbook::HandleIOC(Order& order)
 {
    const Volume required = order.GetInitialVolume();
-   Volume accumulated = 0;
-   const Price limit = order.GetPrice();
-   const Side orderSide = order.GetSide();
-   Volume remaining = 0;
-
-   if (orderSide == Side::Buy)
-   {
-      auto it = asks.begin();
-
-      while (accumulated < required && !asks.empty() && limit >= it->first)
-      {         
-         auto& queue = it->second;
-
-         while (accumulated < required && !queue.empty()) 
-         {
-            remaining = required - accumulated;
-            accumulated += ConsumeOrderbookEntry(remaining, queue);
-         }
-         if ( queue.empty() )
-            it = asks.erase(it);
-      }
-   }
-   else
-   {
-      auto it = bids.begin();
-
-      while (accumulated < required && !bids.empty() && limit <= it->first)
-      {         
-         auto& queue = it->second;
-
-         while (accumulated < required && !queue.empty()) 
-         {
-            remaining = required - accumulated;
-            accumulated += ConsumeOrderbookEntry(remaining, queue);
-         }
-         if ( queue.empty() )
-            it = bids.erase(it);
-      }  
-   }   
-   return CleanupOrder(order, accumulated, required);
+   return CleanupOrder(order, Match<S, true>(order, required), required);
 }
 
 // Description: Executes limit order, immediately filling at available 
 // prices or adding remainder to book at specified price.
+template <Side S>
 OrderOutcome Orderbook::HandleLimitOrder(Order& order)
 {
+   using Traits = SideTraits<S>;
+   const PriceLadder<Traits::Opposite>& opposite = Ladder<Traits::Opposite>();
    const Volume required = order.GetInitialVolume();
-   Volume accumulated = 0;
-   const Price limit = order.GetPrice();
-   const Side orderSide = order.GetSide();
 
-   if (orderSide == Side::Buy && (asks.empty() || limit < asks.begin()->first))
+   if (opposite.empty() || !Traits::Crosses(order.GetPrice(), opposite.BestPrice()))
    {
-      orderbookReference[order.GetId()] = {limit, orderSide};
-      bids[limit].push_back(std::move(order));
+      AddToBook<S>(order);
       return OrderOutcome::AddedToOrderbook;
    }
-   else if (orderSide == Side::Sell && (bids.empty() || limit > bids.begin()->first))
+
+   const Volume accumulated = Match<S, true>(order, required);
+   const bool filled = accumulated > selfTradeReduced;
+
+   if (accumulated < required)
    {
-      orderbookReference[order.GetId()] = {limit, orderSide};
-      asks[limit].push_back(std::move(order));
-      return OrderOutcome::AddedToOrderbook;
+      order.SetRemainingVolume(required - accumulated);
+      AddToBook<S>(order);
+      return filled ? OrderOutcome::PartiallyFilledAndAddedToBook : OrderOutcome::AddedToOrderbook;
    }
 
-   if (orderSide == Side::Buy)
+   if (selfTradeReduced != 0)
    {
-      auto it = asks.begin();
-
-      while (accumulated < required && !asks.empty() && limit >= it->first)
-      {
-         auto& queue = it->second;
-
-         while (accumulated < required && !queue.empty()) 
-         {
-            const Volume remaining = required - accumulated;
-            accumulated += ConsumeOrderbookEntry(remaining, queue);
-         }
-         if (queue.empty())
-           it = asks.erase(it);
-      }
+      completedOrders.Add(std::move(order));
+      return filled ? OrderOutcome::PartiallyFilledAndCancelled : OrderOutcome::Cancelled;
    }
-   else
-   {
-      auto it = bids.begin();
 
-      while (accumulated < required && !bids.empty() && limit <= it->first)
-      {         
-         auto& queue = it->second;
+   completedOrders.Add(std::move(order));
+   return OrderOutcome::FullyFilled;
+}
 
-         while (accumulated < required && !queue.empty()) 
-         {
-            const Volume remaining = required - accumulated;
-            accumulated += ConsumeOrderbookEntry(remaining, queue);
-         }
-         if (queue.empty())
-            it = bids.erase(it);
-      }
-   }
-   
-   if (accumulated < required)
+// Description: Appends an order to the back of its price level and 
+// records its slot so it can later be found without a scan.
+template <Side S>
+void Orderbook::AddToBook(Order& order)
+{
+   const Price price = order.GetPrice();
+
+   if (l3Encoder)
+      l3Encoder->Add(order.GetId(), S, price, order.GetRemainingVolume());
+
+   PriceLevel& level = Ladder<S>()[price];
+   const SlotIndex slot = Reference(orderbookReference, order);
+   level.Append(slab, slot);
+   ScheduleExpiry(slot);
+   PublishLevel(S, price, level);
+}
+
+// Description: Parks a stop order in the trigger index, or fires it at
+// once if the last trade has already crossed its stop price.
+OrderOutcome Orderbook::HandleStopOrder(Order& order)
+{
+   const Price stopPrice = order.GetStopPrice();
+   const Side side = order.GetSide();
+
+   if (IsStopTriggered(side, stopPrice))
+      return TriggerStop(order);
+
+   PriceLevel& level = (side == Side::Buy) ? buyStops[stopPrice] : sellStops[stopPrice];
+   level.Append(slab, Reference(stopReference, order));
+   return OrderOutcome::AddedToOrderbook;
+}
+
+// Description: A buy stop fires once the last trade is at or above its
+// stop price, a sell stop once it is at or below.
+bool Orderbook::IsStopTriggered(const Side side, const Price stopPrice) const
+{
+   if (!hasLastTrade)
+      return false;
+
+   return (side == Side::Buy) ? lastTradePrice >= stopPrice : lastTradePrice <= stopPrice;
+}
+
+// Description: Reports the trigger and runs the stop as the market or
+// limit order it stands for, under the same ID.
+OrderOutcome Orderbook::TriggerStop(Order& stop)
+{
+   Publish(ExecutionEventType::Triggered, stop, stop.GetRemainingVolume());
+
+   const OrderType type = (stop.GetType() == OrderType::Stop) ? OrderType::Market : OrderType::GoodTillCancel;
+   Order order(type, stop.GetId(), stop.GetPrice(), stop.GetSide(), stop.GetRemainingVolume());
+   order.SetOwner(stop.GetOwner());
+   order.SetSelfTradePrevention(stop.GetSelfTradePrevention());
+   return ProcessOrder(order);
+}
+
+// Description: Fires every stop crossed by any fill since the last
+// release, nearest stop price first and FIFO within a price: buy stops up
+// to the highest fill, sell stops down to the lowest. Only the best level
+// of each stop ladder is examined, so the cost is proportional to the
+// stops released. Their fills can widen the range, so this repeats until
+// no stop is crossed.
+void Orderbook::ReleaseTriggeredStops()
+{
+   while (true)
    {
-      order.SetRemainingVolume(required - accumulated);
-      orderbookReference[order.GetId()] = {limit, orderSide};
+      PriceLevel* level = nullptr;
+      bool buySide = false;
 
-      if (orderSide == Side::Buy)      
-         bids[limit].push_back(std::move(order));
+      if (!buyStops.empty() && buyStops.BestPrice() <= tradeHigh)
+      {
+         level = &buyStops.Best();
+         buySide = true;
+      }
+      else if (!sellStops.empty() && sellStops.BestPrice() >= tradeLow)
+      {
+         level = &sellStops.Best();
+      }
       else
-         asks[limit].push_back(std::move(order));
-      return OrderOutcome::PartiallyFilledAndAddedToBook;
+      {
+         break;
+      }
+
+      const SlotIndex slot = level->PopFront(slab);
+      if (level->empty())
+      {
+         if (buySide)
+            buyStops.PopBest();
+         else
+            sellStops.PopBest();
+      }
+      Order stop = slab.ToOrder(slot);
+      Unreference(stopReference, stopReference.Find(stop.GetId()));
+
+      (void)TriggerStop(stop);
    }
-   
-   completedOrders.Add(std::move(order));
-   return OrderOutcome::FullyFilled;
+
+   tradeLow = std::numeric_limits<Price>::max();
+   tradeHigh = std::numeric_limits<Price>::min();
+}
+
+// Description: Cancels a pending stop order.
+bool Orderbook::RemoveStop(const ID orderID)
+{
+   OrderReference::Entry* reference = stopReference.Find(orderID);
+
+   if (!reference)
+      return false;
+
+   const SlotIndex slot = reference->slot;
+   const RestingOrderDetails& details = slab.Details(slot);
+   const Price stopPrice = details.stopPrice;
+   Publish(ExecutionEventType::Cancelled, slot, slab[slot].remaining);
+
+   if (details.side == Side::Buy)
+      EraseFromLevel(buyStops, stopPrice, slot);
+   else
+      EraseFromLevel(sellStops, stopPrice, slot);
+
+   Unreference(stopReference, reference);
+   return true;
 }
 
 // Description: Matches incoming order against top-of-book resting 
-// order, consuming available volume.
-Volume Orderbook::ConsumeOrderbookEntry(const Volume toBeFilledVolume, std::deque<Order>& queue)
+// order, consuming available volume and reporting the fill. A resting
+// order from the taker's own owner is handed to self-trade prevention
+// instead; selfTradeOwner never matches when the taker has no mode set.
+// Only the maker's compact record is read unless it fills completely.
+template <Side S>
+Volume Orderbook::ConsumeOrderbookEntry(const Order& taker, const Volume toBeFilledVolume, PriceLevel& level,
+                                        const Price price, const OwnerID selfTradeOwner)
 {
-   Order& topOfBook = queue.front();
-   const Volume topOfBookVolume = topOfBook.GetRemainingVolume();
+   RestingOrder& topOfBook = slab[level.Front()];
+   if (topOfBook.owner == selfTradeOwner) [[unlikely]]
+      return PreventSelfTrade<S>(taker, toBeFilledVolume, level, price);
+
+   const Volume topOfBookVolume = topOfBook.remaining;
+   constexpr Side makerSide = SideTraits<S>::Opposite;
+   const ID makerId = topOfBook.id;
+   Volume filled;
+
+   lastTradePrice = price;
+   hasLastTrade = true;
+   tradeLow = std::min(tradeLow, price);
+   tradeHigh = std::max(tradeHigh, price);
 
    if (toBeFilledVolume >= topOfBookVolume)
    {
-      HandleFilledOrder(queue);
-      return topOfBookVolume;
+      executionEvents.Push({ExecutionEventType::Fill, makerSide, makerId,
+                            taker.GetId(), price, topOfBookVolume, 0});
+      HandleFilledOrder(level);
+      filled = topOfBookVolume;
    }
    else
    {
       const Volume leftOver = topOfBookVolume - toBeFilledVolume;
-      topOfBook.SetRemainingVolume(leftOver);
-      return toBeFilledVolume;
+      topOfBook.remaining = leftOver;
+      level.ReduceVolume(toBeFilledVolume);
+      executionEvents.Push({ExecutionEventType::PartialFill, makerSide, makerId,
+                            taker.GetId(), price, toBeFilledVolume, leftOver});
+      filled = toBeFilledVolume;
    }
+
+   if (l3Encoder)
+      l3Encoder->Execute(makerId, makerSide, price, filled);
+
+   PublishLevel(makerSide, price, level);
+   return filled;
 }
 
-// Description: Validates order eligibility by checking volume, 
-// available liquidity, and order-type-specific requirements.
-bool Orderbook::CanProcessOrder(const Order& order) const
+// Description: The owner a taker must not trade with, or a reserved
+// value no resting order carries when the taker has no prevention mode.
+OwnerID Orderbook::SelfTradeOwner(const Order& taker)
 {
-   if (order.GetInitialVolume() <= 0)
-       return false;
+   if (taker.GetSelfTradePrevention() == SelfTradePrevention::None || taker.GetOwner() == 0)
+      return NoSelfTradeOwner;
+   return taker.GetOwner();
+}
 
-   if (order.GetType() == OrderType::Market)
-   {
-      if ((order.GetSide() == Side::Buy && asks.empty()) ||
-          (order.GetSide() == Side::Sell && bids.empty()))
-      {
-          return false;
-      }
-   }
+// Description: Resolves a cross between a taker and a resting order of
+// the same owner by the taker's prevention mode, without trading. Returns
+// how much of the taker's remaining volume that used up, which the
+// matching loops count like a fill; the resting order leaves the level if
+// it is cancelled outright.
+template <Side S>
+Volume Orderbook::PreventSelfTrade(const Order& taker, const Volume remaining, PriceLevel& level,
+                                   const Price makerPrice)
+{
+   RestingOrder& maker = slab[level.Front()];
+   const Volume makerVolume = maker.remaining;
+   constexpr Side makerSide = SideTraits<S>::Opposite;
+   const ID makerId = maker.id;
+   Volume makerReduced = 0;
+   Volume takerReduced = 0;
 
-   if (order.GetType() == OrderType::FillOrKill)
+   switch (taker.GetSelfTradePrevention())
    {
-       if (order.GetSide() == Side::Buy)
-           return HasSufficientVolume(order, asks);
-       else
-           return HasSufficientVolume(order, bids);
+      case SelfTradePrevention::CancelNewest:
+         takerReduced = remaining;
+         break;
+
+      case SelfTradePrevention::CancelOldest:
+         makerReduced = makerVolume;
+         break;
+
+      case SelfTradePrevention::CancelBoth:
+         takerReduced = remaining;
+         makerReduced = makerVolume;
+         break;
+
+      default:
+         takerReduced = makerReduced = std::min(remaining, makerVolume);
+         break;
    }
 
-   if (order.GetType() == OrderType::ImmediateOrCancel)
+   if (makerReduced != 0)
    {
-      if (order.GetSide() == Side::Buy)
+      executionEvents.Push({ExecutionEventType::SelfTradePrevented, makerSide, makerId, taker.GetId(),
+                            makerPrice, makerReduced, makerVolume - makerReduced});
+
+      if (makerReduced == makerVolume)
       {
-         if (!asks.empty() && order.GetPrice() < asks.begin()->first)
-            return false;
+         if (l3Encoder)
+            l3Encoder->Delete(makerId, makerSide, makerPrice);
+
+         (void)level.PopFront(slab);
+         Unreference(orderbookReference, orderbookReference.Find(makerId));
       }
       else
       {
-         if (!bids.empty() && order.GetPrice() > bids.begin()->first)
-             return false;
+         if (l3Encoder)
+            l3Encoder->Cancel(makerId, makerSide, makerPrice, makerReduced);
+
+         maker.remaining = makerVolume - makerReduced;
+         level.ReduceVolume(makerReduced);
       }
+      PublishLevel(makerSide, makerPrice, level);
    }
 
-   return true;
+   if (takerReduced != 0)
+   {
+      executionEvents.Push({ExecutionEventType::SelfTradePrevented, S, taker.GetId(), makerId,
+                            makerPrice, takerReduced, remaining - takerReduced});
+      selfTradeReduced += takerReduced;
+   }
+   return takerReduced;
 }
 
-// Description: Overload for asks map to check if sufficient
-// volume exists for Fill-or-Kill buy orders.
-bool Orderbook::HasSufficientVolume(const Order& order,
-                                    const std::map<double, std::deque<Order>>& bookSide) const
+// Description: Records a non-fill execution report for an order.
+void Orderbook::Publish(const ExecutionEventType type, const Order& order, const Volume quantity)
 {
-   return HasSufficientBuyVolume(order, bookSide);
+   executionEvents.Push({type, order.GetSide(), order.GetId(), 0, order.GetPrice(), quantity, order.GetRemainingVolume()});
 }
 
-// Description: Overload for bids map to check if sufficient volume exists for Fill-or-Kill sell orders.
-bool Orderbook::HasSufficientVolume(const Order& order,
-                                    const std::map<double, std::deque<Order>, std::greater<double>>& bookSide) const
+// Description: Records a non-fill execution report for the order in a slot.
+void Orderbook::Publish(const ExecutionEventType type, const SlotIndex slot, const Volume quantity)
 {
-   return HasSufficientSellVolume(order, bookSide);
+   const RestingOrderDetails& details = slab.Details(slot);
+   executionEvents.Push({type, details.side, slab[slot].id, 0, details.price, quantity, slab[slot].remaining});
 }
 
-// Description: Calculates total available volume in asks up to 
-// limit price for Fill-or-Kill validation.
-bool Orderbook::HasSufficientBuyVolume(
-   const Order& order,
-   const std::map<double, std::deque<Order>>& asks) const
+// Description: Records a level's new aggregate for the L2 feed.
+void Orderbook::PublishLevel(const Side side, const Price price, const PriceLevel& level)
 {
-   const Volume required = order.GetInitialVolume();
-   Volume accumulated = 0;
-   const Price limit = order.GetPrice();
+   levelUpdates.Push({side, price, level.GetTotalVolume(), level.GetOrderCount()});
+}
+
+// Description: Validates order eligibility by checking volume, 
+// available liquidity, and order-type-specific requirements.
+template <Side S>
+bool Orderbook::CanProcessOrder(const Order& order) const
+{
+   using Traits = SideTraits<S>;
+   const PriceLadder<Traits::Opposite>& opposite = Ladder<Traits::Opposite>();
+
+   if (order.GetInitialVolume() <= 0)
+       return false;
 
-   for (auto it = asks.begin(); it != asks.end(); ++it)
+   if ((order.GetType() == OrderType::GoodTillDate || order.GetType() == OrderType::Day) &&
+       order.GetExpiry() <= GetTime())
    {
-      if (it->first > limit)
-         break;
+      return false;
+   }
 
-      for (const auto& restingOrder : it->second)
-         accumulated += restingOrder.GetRemainingVolume();
+   if (order.GetType() == OrderType::Market && opposite.empty())
+      return false;
 
-      if (accumulated >= required)
-         return true;
+   if (order.GetType() == OrderType::FillOrKill)
+      return HasSufficientVolume<S>(order);
+
+   if (order.GetType() == OrderType::ImmediateOrCancel)
+   {
+      if (!opposite.empty() && !Traits::Crosses(order.GetPrice(), opposite.BestPrice()))
+         return false;
    }
-   return false;
+
+   return true;
 }
 
-// Description: Calculates total available volume in bids down to limit price for Fill-or-Kill validation.
-bool Orderbook::HasSufficientSellVolume(
-   const Order& order,
-   const std::map<double, std::deque<Order>, std::greater<double>>& bids) const
+// Description: Adds up the opposite side's volume within the limit price
+// for Fill-or-Kill validation. Level totals are enough except on the
+// levels where the taker's owner rests, which are the only ones counted
+// order by order.
+template <Side S>
+bool Orderbook::HasSufficientVolume(const Order& order) const
 {
+   using Traits = SideTraits<S>;
    const Volume required = order.GetInitialVolume();
    Volume accumulated = 0;
    const Price limit = order.GetPrice();
 
-   for (auto it = bids.begin(); it != bids.end(); ++it)
+   const OwnerID selfTradeOwner = SelfTradeOwner(order);
+   bool blocked = false;
+
+   ownerLevels.clear();
+   if (selfTradeOwner != NoSelfTradeOwner)
+      CollectOwnerLevels<S>(order, selfTradeOwner);
+   auto ownerLevel = ownerLevels.cbegin();
+
+   Ladder<Traits::Opposite>().ForEachLevel([&](const Price price, const PriceLevel& level)
    {
-      if (it->first < limit)
-         break;
+      if (!Traits::Crosses(limit, price))
+         return false;
 
-      for (const auto& restingOrder : it->second)
-         accumulated += restingOrder.GetRemainingVolume();
+      if (ownerLevel == ownerLevels.cend() || *ownerLevel != price)
+      {
+         accumulated += level.GetTotalVolume();
+         return accumulated < required;
+      }
+      ++ownerLevel;
+      return CountFillableVolume(order, level, selfTradeOwner, accumulated, blocked);
+   });
+   return !blocked && accumulated >= required;
+}
 
-      if (accumulated >= required)
-         return true;
+// Description: Fills ownerLevels with the distinct prices at which owner
+// has orders resting on the side order would trade against, within its
+// limit, in the order the book would reach them. Walks only the owner's
+// own list.
+template <Side S>
+void Orderbook::CollectOwnerLevels(const Order& order, const OwnerID owner) const
+{
+   using Traits = SideTraits<S>;
+
+   auto ownerIt = owners.find(owner);
+   if (ownerIt == owners.end())
+      return;
+
+   for (SlotIndex slot = ownerIt->second.head; slot != NoSlot; slot = slab.Details(slot).ownerNext)
+   {
+      const RestingOrderDetails& details = slab.Details(slot);
+      const bool pendingStop = details.type == OrderType::Stop || details.type == OrderType::StopLimit;
+      if (!pendingStop && details.side == Traits::Opposite && Traits::Crosses(order.GetPrice(), details.price))
+         ownerLevels.push_back(details.price);
    }
-   return false;
+
+   // Touch first: ascending asks for a buyer, descending bids for a seller.
+   if constexpr (S == Side::Buy)
+      std::sort(ownerLevels.begin(), ownerLevels.end());
+   else
+      std::sort(ownerLevels.begin(), ownerLevels.end(), std::greater<Price>());
+   ownerLevels.erase(std::unique(ownerLevels.begin(), ownerLevels.end()), ownerLevels.end());
+}
+
+// Description: Adds up a level order by order for a Fill-or-Kill whose
+// owner rests on it: the owner's own orders are skipped under
+// CancelOldest, and under any other mode reaching one first would cut
+// the fill short, so the order is blocked. Returns whether to keep going.
+bool Orderbook::CountFillableVolume(const Order& order, const PriceLevel& level, const OwnerID selfTradeOwner,
+                                    Volume& accumulated, bool& blocked) const
+{
+   bool more = true;
+
+   level.ForEach(slab, [&](const SlotIndex slot)
+   {
+      const RestingOrder& maker = slab[slot];
+      if (maker.owner == selfTradeOwner)
+      {
+         if (order.GetSelfTradePrevention() == SelfTradePrevention::CancelOldest)
+            return true;
+         blocked = true;
+         more = false;
+      }
+      else
+      {
+         accumulated += maker.remaining;
+         more = accumulated < order.GetInitialVolume();
+      }
+      return more;
+   });
+   return more;
 }
\ No newline at end of file
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <vector>
+#include <map>
+#include <functional>
+#include <type_traits>
+#include <memory_resource>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#include "PriceLevel.h"
+
+// One side of the book as a contiguous array of price levels indexed by
+// tick offset from a base price, covering a fixed window around the touch.
+// The best and worst occupied slots in the window are tracked as cursors,
+// so best-price lookup, insert and erase near the touch are array
+// accesses. Levels further from the touch than the window reaches are
+// kept in a sparse overflow map, so the memory a ladder uses does not
+// depend on how far apart its prices are. The window is allocated once;
+// when the touch moves outside it, it is re-centred in place and levels
+// cross between the array and the map.
+template <Side S>
+class PriceLadder
+{
+public:
+   using Level = PriceLevel;
+
+   explicit PriceLadder(std::size_t capacity = 4096,
+                        std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+      : levels(std::bit_ceil(std::max<std::size_t>(capacity, 2)), resource),
+        overflow(resource)
+   {}
+
+   bool empty() const { return LevelCount() == 0; }
+   std::size_t LevelCount() const { return levelCount + overflow.size(); }
+
+   // The touch is always inside the window.
+   Price BestPrice() const { return PriceAt(best); }
+   Level& Best() { return levels[best]; }
+   const Level& Best() const { return levels[best]; }
+
+   // Returns the level at price, creating it (and widening the occupied
+   // range) if it does not exist. The caller must leave it non-empty.
+   Level& operator[](const Price price)
+   {
+      if (!InWindow(price))
+      {
+         // A new touch moves the window; anything else beyond it is
+         // further out than every level in it.
+         if (!empty() && !IsBetterPrice(price, BestPrice()))
+            return overflow[price];
+         Recentre(price);
+      }
+
+      const std::size_t index = IndexOf(price);
+
+      if (levels[index].empty())
+      {
+         if (levelCount == 0)
+         {
+            best = worst = index;
+         }
+         else
+         {
+            if (IsBetter(index, best))
+               best = index;
+            if (IsBetter(worst, index))
+               worst = index;
+         }
+         ++levelCount;
+      }
+      return levels[index];
+   }
+
+   Level* Find(const Price price)
+   {
+      if (!InWindow(price))
+      {
+         auto it = overflow.find(price);
+         return it == overflow.end() ? nullptr : &it->second;
+      }
+      if (levelCount == 0 || levels[IndexOf(price)].empty())
+         return nullptr;
+      return &levels[IndexOf(price)];
+   }
+
+   const Level* Find(const Price price) const
+   {
+      return const_cast<PriceLadder*>(this)->Find(price);
+   }
+
+   // Releases a level that has just been emptied, moving the cursors past
+   // it when it was at either end of the occupied range. References to
+   // levels do not survive this.
+   void Erase(const Price price)
+   {
+      if (!InWindow(price))
+      {
+         overflow.erase(price);
+         return;
+      }
+
+      const std::size_t index = IndexOf(price);
+
+      if (--levelCount == 0)
+      {
+         if (!overflow.empty())
+            Recentre(overflow.begin()->first);
+         return;
+      }
+
+      if (index == best)
+         best = NextOccupied(best);
+      else if (index == worst)
+         worst = PreviousOccupied(worst);
+   }
+
+   void PopBest() { Erase(BestPrice()); }
+
+   // Hands every occupied level priced within [low, high] to drop, which
+   // must empty it, then releases them together. Only the slots inside
+   // both the range and the occupied span are walked, and the cursors are
+   // moved once at the end rather than level by level. Overflow levels in
+   // range are dropped after the window's.
+   template <typename Visitor>
+   void EraseRange(const Price low, const Price high, Visitor&& drop)
+   {
+      if (low > high)
+         return;
+
+      if (levelCount != 0)
+         EraseWindowRange(low, high, drop);
+
+      for (auto it = overflow.lower_bound(S == Side::Buy ? high : low);
+           it != overflow.end() && it->first >= low && it->first <= high; )
+      {
+         drop(it->first, it->second);
+         it = overflow.erase(it);
+      }
+
+      if (levelCount == 0 && !overflow.empty())
+         Recentre(overflow.begin()->first);
+   }
+
+   // Visits occupied levels from the touch outwards until visit returns false.
+   template <typename Visitor>
+   void ForEachLevel(Visitor&& visit) const
+   {
+      if (levelCount == 0)
+         return;
+
+      for (std::size_t index = best; ; index = Step(index))
+      {
+         if (!levels[index].empty() && !visit(PriceAt(index), levels[index]))
+            return;
+         if (index == worst)
+            break;
+      }
+
+      for (const auto& [price, level] : overflow)
+      {
+         if (!visit(price, level))
+            return;
+      }
+   }
+
+private:
+   using LevelArray = std::pmr::vector<Level>;
+
+   // Ordered touch first, like the window.
+   using Further = std::conditional_t<S == Side::Buy, std::greater<Price>, std::less<Price>>;
+
+   LevelArray levels;
+   std::pmr::map<Price, Level, Further> overflow;
+   Price basePrice = 0;
+   std::size_t best = 0;
+   std::size_t worst = 0;
+   std::size_t levelCount = 0;   // occupied levels in the window
+
+   // Buy ladders improve towards higher prices, sell ladders towards lower.
+   static bool IsBetter(const std::size_t lhs, const std::size_t rhs)
+   {
+      if constexpr (S == Side::Buy)
+         return lhs > rhs;
+      else
+         return lhs < rhs;
+   }
+
+   static bool IsBetterPrice(const Price lhs, const Price rhs)
+   {
+      if constexpr (S == Side::Buy)
+         return lhs > rhs;
+      else
+         return lhs < rhs;
+   }
+
+   // One slot further away from the touch.
+   static std::size_t Step(const std::size_t index)
+   {
+      if constexpr (S == Side::Buy)
+         return index - 1;
+      else
+         return index + 1;
+   }
+
+   // One slot closer to the touch.
+   static std::size_t StepBack(const std::size_t index)
+   {
+      if constexpr (S == Side::Buy)
+         return index + 1;
+      else
+         return index - 1;
+   }
+
+   std::size_t NextOccupied(std::size_t index) const
+   {
+      do { index = Step(index); } while (levels[index].empty());
+      return index;
+   }
+
+   std::size_t PreviousOccupied(std::size_t index) const
+   {
+      do { index = StepBack(index); } while (levels[index].empty());
+      return index;
+   }
+
+   // Offsets are taken in unsigned arithmetic so that prices anywhere in
+   // the Price range compare against the window without overflowing.
+   static std::uint64_t Offset(const Price price, const Price base)
+   {
+      return static_cast<std::uint64_t>(price) - static_cast<std::uint64_t>(base);
+   }
+
+   bool InWindow(const Price price) const { return Offset(price, basePrice) < levels.size(); }
+
+   std::size_t IndexOf(const Price price) const { return static_cast<std::size_t>(Offset(price, basePrice)); }
+   Price PriceAt(const std::size_t index) const { return basePrice + static_cast<Price>(index); }
+
+   // The base that puts centre mid-window, kept far enough from either end
+   // of the Price range that every slot has a price.
+   Price WindowBase(const Price centre) const
+   {
+      const Price half = static_cast<Price>(levels.size() / 2);
+      const Price lowest = std::numeric_limits<Price>::min();
+      const Price highest = std::numeric_limits<Price>::max() - static_cast<Price>(levels.size() - 1);
+
+      if (centre < lowest + half)
+         return lowest;
+      if (centre - half > highest)
+         return highest;
+      return centre - half;
+   }
+
+   // Drops the window's levels within [low, high] and fixes the cursors.
+   template <typename Visitor>
+   void EraseWindowRange(const Price low, const Price high, Visitor& drop)
+   {
+      const Price first = std::max(low, PriceAt(std::min(best, worst)));
+      const Price last = std::min(high, PriceAt(std::max(best, worst)));
+      if (first > last)
+         return;
+
+      const bool bestDropped = PriceAt(best) >= first && PriceAt(best) <= last;
+      const bool worstDropped = PriceAt(worst) >= first && PriceAt(worst) <= last;
+
+      for (std::size_t index = IndexOf(first); index <= IndexOf(last); ++index)
+      {
+         if (levels[index].empty())
+            continue;
+
+         drop(PriceAt(index), levels[index]);
+         --levelCount;
+      }
+
+      if (levelCount == 0)
+         return;
+
+      // Whatever survives lies beyond the range, on the far side from
+      // the touch for best and on the near side for worst.
+      if constexpr (S == Side::Buy)
+      {
+         if (bestDropped)
+            best = NextOccupied(IndexOf(first));
+         if (worstDropped)
+            worst = PreviousOccupied(IndexOf(last));
+      }
+      else
+      {
+         if (bestDropped)
+            best = NextOccupied(IndexOf(last));
+         if (worstDropped)
+            worst = PreviousOccupied(IndexOf(first));
+      }
+   }
+
+   // Moves the window to centre on a price that is about to become the
+   // touch, or on the best overflow level once the window has emptied.
+   // Either way every level that leaves the window is further from the
+   // touch than the new window reaches, so the touch stays in the array.
+   // Levels are shifted in place, so this never allocates for the array.
+   void Recentre(const Price centre)
+   {
+      const Price newBase = WindowBase(centre);
+      const std::size_t size = levels.size();
+      std::size_t low = size;
+      std::size_t high = 0;
+
+      if (levelCount != 0)
+      {
+         const std::size_t first = std::min(best, worst);
+         const std::size_t last = std::max(best, worst);
+
+         // Walk in the direction of the shift so that no level lands on
+         // one not yet moved.
+         const bool down = newBase > basePrice;
+         for (std::size_t step = 0; step <= last - first; ++step)
+         {
+            const std::size_t index = down ? first + step : last - step;
+            if (levels[index].empty())
+               continue;
+
+            const Price price = PriceAt(index);
+            Level level = levels[index];
+            levels[index].Clear();
+
+            if (Offset(price, newBase) < size)
+            {
+               const std::size_t moved = static_cast<std::size_t>(Offset(price, newBase));
+               levels[moved] = level;
+               low = std::min(low, moved);
+               high = std::max(high, moved);
+            }
+            else
+            {
+               overflow.emplace(price, level);
+               --levelCount;
+            }
+         }
+      }
+
+      basePrice = newBase;
+
+      // Overflow levels the window now covers come back into the array.
+      for (auto it = overflow.lower_bound(S == Side::Buy ? PriceAt(size - 1) : newBase);
+           it != overflow.end() && InWindow(it->first); )
+      {
+         const std::size_t index = IndexOf(it->first);
+         levels[index] = it->second;
+         low = std::min(low, index);
+         high = std::max(high, index);
+         ++levelCount;
+         it = overflow.erase(it);
+      }
+
+      if (levelCount != 0)
+      {
+         best = (S == Side::Buy) ? high : low;
+         worst = (S == Side::Buy) ? low : high;
+      }
+   }
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+
+#include "OrderSlab.h"
+
+// A price level's FIFO queue together with its running aggregates. The
+// queue is threaded through the orders' slots in the book's OrderSlab as a
+// doubly-linked list, so an order is unlinked in O(1) given its slot,
+// without disturbing the others, and the level itself is a few words that
+// the ladder can move freely. Every change to the resting volume at the
+// level goes through here so that the total volume and order count never
+// need to be recomputed from the orders.
+class PriceLevel
+{
+public:
+   bool empty() const { return m_orderCount == 0; }
+   Volume GetTotalVolume() const { return m_totalVolume; }
+   std::size_t GetOrderCount() const { return m_orderCount; }
+
+   SlotIndex Front() const { return m_head; }
+
+   void Append(OrderSlab& slab, const SlotIndex slot)
+   {
+      RestingOrder& order = slab[slot];
+      order.next = NoSlot;
+      order.previous = m_tail;
+
+      if (m_tail != NoSlot)
+         slab[m_tail].next = slot;
+      else
+         m_head = slot;
+      m_tail = slot;
+
+      m_totalVolume += order.remaining;
+      ++m_orderCount;
+   }
+
+   void Erase(OrderSlab& slab, const SlotIndex slot)
+   {
+      const RestingOrder& order = slab[slot];
+
+      if (order.previous != NoSlot)
+         slab[order.previous].next = order.next;
+      else
+         m_head = order.next;
+
+      if (order.next != NoSlot)
+         slab[order.next].previous = order.previous;
+      else
+         m_tail = order.previous;
+
+      m_totalVolume -= order.remaining;
+      --m_orderCount;
+   }
+
+   SlotIndex PopFront(OrderSlab& slab)
+   {
+      const SlotIndex slot = m_head;
+      Erase(slab, slot);
+      return slot;
+   }
+
+   // Visits the slots in queue order until visit returns false. visit may
+   // release the slot it is given.
+   template <typename Visitor>
+   void ForEach(const OrderSlab& slab, Visitor&& visit) const
+   {
+      for (SlotIndex slot = m_head; slot != NoSlot; )
+      {
+         const SlotIndex next = slab[slot].next;
+         if (!visit(slot))
+            return;
+         slot = next;
+      }
+   }
+
+   // Forgets every order at once; their slots are the caller's to release.
+   void Clear()
+   {
+      m_head = m_tail = NoSlot;
+      m_totalVolume = 0;
+      m_orderCount = 0;
+   }
+
+   // Records that a resting order's remaining volume shrank in place.
+   void ReduceVolume(const Volume delta) { m_totalVolume -= delta; }
+
+private:
+   SlotIndex m_head = NoSlot;
+   SlotIndex m_tail = NoSlot;
+   Volume m_totalVolume = 0;
+   std::size_t m_orderCount = 0;
+};
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vector>
+#include <bit>
+#include <cstddef>
+#include <algorithm>
+
+// Fixed-capacity FIFO over storage allocated once at construction. Push
+// never allocates: when the consumer falls behind the oldest entry is
+// overwritten and counted as an overrun, so the producer (the matching
+// loop) is never blocked. Single-threaded; drain it from the thread that
+// drives the book.
+template <typename T>
+class RingBuffer
+{
+public:
+   explicit RingBuffer(std::size_t capacity)
+      : m_slots(std::bit_ceil(std::max<std::size_t>(capacity, 1))),
+        m_mask(m_slots.size() - 1)
+   {}
+
+   void Push(const T& value)
+   {
+      if (size() == m_slots.size())
+      {
+         ++m_head;
+         ++m_overruns;
+      }
+      m_slots[m_tail++ & m_mask] = value;
+   }
+
+   bool Pop(T& value)
+   {
+      if (empty())
+         return false;
+      value = m_slots[m_head++ & m_mask];
+      return true;
+   }
+
+   // Hands every buffered entry to visit, oldest first, and empties the ring.
+   template <typename Visitor>
+   void Drain(Visitor&& visit)
+   {
+      while (m_head != m_tail)
+         visit(m_slots[m_head++ & m_mask]);
+   }
+
+   const T& operator[](std::size_t index) const { return m_slots[(m_head + index) & m_mask]; }
+
+   bool empty() const { return m_head == m_tail; }
+   std::size_t size() const { return static_cast<std::size_t>(m_tail - m_head); }
+   std::size_t capacity() const { return m_slots.size(); }
+   std::size_t GetOverrunCount() const { return m_overruns; }
+
+   void Clear() { m_head = m_tail; }
+
+private:
+   std::vector<T> m_slots;
+   std::size_t m_mask;
+   std::size_t m_head = 0;
+   std::size_t m_tail = 0;
+   std::size_t m_overruns = 0;
+};
@@ -0,0 +1,202 @@
+#include "OrderBook.h"
+#include "Journal.h"
+#include "MappedFile.h"
+#include "Snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+static constexpr char SnapshotMagic[8] = {'L', 'O', 'B', 'S', 'N', 'A', 'P', '1'};
+static constexpr std::uint32_t SnapshotVersion = 4;
+
+// Description: Writes the resting book and pending stops into a file sized
+// up front and mapped once; records are copied straight into the mapping.
+bool Orderbook::SaveSnapshot(const std::string& path) const
+{
+   SnapshotHeader header{};
+   std::memcpy(header.magic, SnapshotMagic, sizeof(SnapshotMagic));
+   header.version = SnapshotVersion;
+   header.orderSize = sizeof(SnapshotOrder);
+   header.tickSize = tickSize;
+   header.nextOrderId = nextOrderID;
+   header.journalPosition = journal ? journal->GetRecordCount() : 0;
+   header.bidLevels = bids.LevelCount();
+   header.askLevels = asks.LevelCount();
+   header.orderCount = orderbookReference.size();
+   header.stopCount = stopReference.size();
+   header.lastTradePrice = lastTradePrice;
+   header.hasLastTrade = hasLastTrade ? 1 : 0;
+   header.time = expiries.Now();
+   header.sessionClose = sessionClose;
+
+   // Everything the snapshot claims to cover must already be durable in the journal.
+   if (journal && !journal->Sync())
+      return false;
+
+   const std::size_t size = sizeof(SnapshotHeader)
+                          + (header.bidLevels + header.askLevels) * sizeof(SnapshotLevel)
+                          + header.orderCount * sizeof(SnapshotOrder)
+                          + header.stopCount * sizeof(SnapshotStop);
+
+   MappedFile file;
+   if (!file.Create(path, size))
+      return false;
+
+   std::memcpy(file.GetData(), &header, sizeof(header));
+   SnapshotLevel* levels = reinterpret_cast<SnapshotLevel*>(file.GetData() + sizeof(SnapshotHeader));
+   SnapshotOrder* orders = reinterpret_cast<SnapshotOrder*>(levels + header.bidLevels + header.askLevels);
+
+   auto write = [&](const Price price, const PriceLevel& level)
+   {
+      *levels++ = {price, level.GetOrderCount()};
+      level.ForEach(slab, [&](const SlotIndex slot)
+      {
+         const RestingOrder& order = slab[slot];
+         const RestingOrderDetails& details = slab.Details(slot);
+         *orders++ = {order.id, details.initialVolume, order.remaining, details.expiry,
+                      static_cast<std::uint8_t>(details.type),
+                      static_cast<std::uint8_t>(details.selfTradePrevention), {}, order.owner};
+         return true;
+      });
+      return true;
+   };
+   bids.ForEachLevel(write);
+   asks.ForEachLevel(write);
+
+   SnapshotStop* stops = reinterpret_cast<SnapshotStop*>(orders);
+   auto writeStops = [this, &stops](const Price, const PriceLevel& level)
+   {
+      level.ForEach(slab, [&](const SlotIndex slot)
+      {
+         const RestingOrder& order = slab[slot];
+         const RestingOrderDetails& details = slab.Details(slot);
+         *stops++ = {order.id, details.price, details.stopPrice, details.initialVolume,
+                     order.remaining, static_cast<std::uint8_t>(details.type),
+                     static_cast<std::uint8_t>(details.side),
+                     static_cast<std::uint8_t>(details.selfTradePrevention), 0, order.owner};
+         return true;
+      });
+      return true;
+   };
+   buyStops.ForEachLevel(writeStops);
+   sellStops.ForEachLevel(writeStops);
+
+   return file.Flush(0, size);
+}
+
+// Description: Maps a snapshot read-only and rebuilds the book from it. The
+// reference map is sized for every order before the first insert, and
+// levels arrive touch first so each ladder's window settles on its first
+// level; the load never rehashes or re-centres.
+bool Orderbook::LoadSnapshot(const std::string& path, std::uint64_t* journalPosition)
+{
+   if (!orderbookReference.empty() || !stopReference.empty())
+      return false;
+
+   MappedFile file;
+   if (!file.OpenReadOnly(path) || file.GetSize() < sizeof(SnapshotHeader))
+      return false;
+
+   SnapshotHeader header;
+   std::memcpy(&header, file.GetData(), sizeof(header));
+
+   const std::uint64_t levelCount = header.bidLevels + header.askLevels;
+   if (std::memcmp(header.magic, SnapshotMagic, sizeof(SnapshotMagic)) != 0 ||
+       header.version != SnapshotVersion || header.orderSize != sizeof(SnapshotOrder) ||
+       header.tickSize != tickSize ||
+       file.GetSize() != sizeof(SnapshotHeader) + levelCount * sizeof(SnapshotLevel)
+                                                + header.orderCount * sizeof(SnapshotOrder)
+                                                + header.stopCount * sizeof(SnapshotStop))
+   {
+      return false;
+   }
+
+   const SnapshotLevel* levels = reinterpret_cast<const SnapshotLevel*>(file.GetData() + sizeof(SnapshotHeader));
+   const SnapshotOrder* orders = reinterpret_cast<const SnapshotOrder*>(levels + levelCount);
+
+   // Check the level counts add up before touching the book.
+   std::uint64_t ordersInLevels = 0;
+   for (std::uint64_t i = 0; i < levelCount; ++i)
+   {
+      if (levels[i].orderCount == 0)
+         return false;
+      ordersInLevels += levels[i].orderCount;
+   }
+   if (ordersInLevels != header.orderCount)
+      return false;
+
+   // And that no order ID is live twice, resting or as a stop.
+   {
+      OrderIndex seen(header.orderCount + header.stopCount);
+      const SnapshotStop* stops = reinterpret_cast<const SnapshotStop*>(orders + header.orderCount);
+      for (std::uint64_t i = 0; i < header.orderCount; ++i)
+      {
+         if (!seen.Insert(orders[i].id, 0))
+            return false;
+      }
+      for (std::uint64_t i = 0; i < header.stopCount; ++i)
+      {
+         if (!seen.Insert(stops[i].id, 0))
+            return false;
+      }
+   }
+
+   expiries.Reset(header.time);
+   sessionClose = header.sessionClose;
+
+   orderbookReference.Reserve(header.orderCount);
+   LoadLevels(bids, levels, header.bidLevels, orders);
+   LoadLevels(asks, levels + header.bidLevels, header.askLevels, orders);
+
+   // Stops are stored in trigger order, so appending keeps each stop
+   // level's FIFO sequence.
+   const SnapshotStop* stops = reinterpret_cast<const SnapshotStop*>(orders);
+   stopReference.Reserve(header.stopCount);
+   for (std::uint64_t i = 0; i < header.stopCount; ++i)
+   {
+      const SnapshotStop& record = stops[i];
+      const Side side = static_cast<Side>(record.side);
+      Order stop(static_cast<OrderType>(record.type), record.id, record.price, side, record.initialVolume,
+                 record.stopPrice);
+      stop.SetRemainingVolume(record.remainingVolume);
+      stop.SetOwner(record.owner);
+      stop.SetSelfTradePrevention(static_cast<SelfTradePrevention>(record.selfTradePrevention));
+
+      PriceLevel& level = (side == Side::Buy) ? buyStops[record.stopPrice] : sellStops[record.stopPrice];
+      level.Append(slab, Reference(stopReference, stop));
+   }
+
+   lastTradePrice = header.lastTradePrice;
+   hasLastTrade = header.hasLastTrade != 0;
+
+   nextOrderID = std::max(nextOrderID, header.nextOrderId);
+   if (journalPosition)
+      *journalPosition = header.journalPosition;
+
+   return true;
+}
+
+// Description: Appends one side's levels and their queues to a ladder,
+// advancing orders past the records consumed.
+template <Side S>
+void Orderbook::LoadLevels(PriceLadder<S>& ladder, const SnapshotLevel* levels, const std::uint64_t levelCount,
+                           const SnapshotOrder*& orders)
+{
+   for (std::uint64_t i = 0; i < levelCount; ++i)
+   {
+      const Price price = levels[i].price;
+      PriceLevel& level = ladder[price];
+
+      for (std::uint64_t n = 0; n < levels[i].orderCount; ++n, ++orders)
+      {
+         Order order(static_cast<OrderType>(orders->type), orders->id, price, S, orders->initialVolume);
+         order.SetRemainingVolume(orders->remainingVolume);
+         order.SetOwner(orders->owner);
+         order.SetSelfTradePrevention(static_cast<SelfTradePrevention>(orders->selfTradePrevention));
+         order.SetExpiry(orders->expiry);
+         const SlotIndex slot = Reference(orderbookReference, order);
+         level.Append(slab, slot);
+         ScheduleExpiry(slot);
+      }
+   }
+}
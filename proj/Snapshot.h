@@ -0,0 +1,70 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+
+// On-disk layout of a book snapshot, written by Orderbook::SaveSnapshot:
+//
+//    SnapshotHeader
+//    SnapshotLevel  x (bidLevels + askLevels)   bids best first, then asks
+//    SnapshotOrder  x orderCount                 level by level, FIFO order
+//    SnapshotStop   x stopCount                  buy stops then sell stops, trigger order
+//
+// Every record is fixed width, so a snapshot is mapped and read in place.
+struct SnapshotHeader
+{
+   char magic[8];
+   std::uint32_t version;
+   std::uint32_t orderSize;
+   double tickSize;
+   std::uint64_t nextOrderId;
+   std::uint64_t journalPosition;   // journal records already reflected in the book
+   std::uint64_t bidLevels;
+   std::uint64_t askLevels;
+   std::uint64_t orderCount;
+   std::uint64_t stopCount;
+   std::int64_t lastTradePrice;
+   std::uint8_t hasLastTrade;
+   std::uint8_t reserved[7];
+   std::uint64_t time;              // the book's clock
+   std::uint64_t sessionClose;
+};
+
+struct SnapshotLevel
+{
+   std::int64_t price;
+   std::uint64_t orderCount;
+};
+
+struct SnapshotOrder
+{
+   std::uint64_t id;
+   std::int64_t initialVolume;
+   std::int64_t remainingVolume;
+   std::uint64_t expiry;
+   std::uint8_t type;
+   std::uint8_t selfTradePrevention;
+   std::uint8_t padding[2];
+   std::uint32_t owner;
+};
+
+struct SnapshotStop
+{
+   std::uint64_t id;
+   std::int64_t price;
+   std::int64_t stopPrice;
+   std::int64_t initialVolume;
+   std::int64_t remainingVolume;
+   std::uint8_t type;
+   std::uint8_t side;
+   std::uint8_t selfTradePrevention;
+   std::uint8_t padding;
+   std::uint32_t owner;
+};
+
+static_assert(sizeof(SnapshotHeader) == 104, "snapshot header is fixed width");
+static_assert(sizeof(SnapshotLevel) == 16, "snapshot levels are fixed width");
+static_assert(sizeof(SnapshotOrder) == 40, "snapshot orders are fixed width");
+static_assert(sizeof(SnapshotStop) == 48, "snapshot stops are fixed width");
+
+#endif
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <bit>
+#include <cstddef>
+#include <algorithm>
+
+// Bounded lock-free single-producer / single-consumer queue. Storage is
+// allocated once; head and tail sit on separate cache lines and each side
+// caches the other's index so the common case touches no shared line.
+// Exactly one thread may call TryPush and exactly one may call TryPop.
+template <typename T>
+class SpscQueue
+{
+public:
+   explicit SpscQueue(std::size_t capacity)
+      : m_slots(std::bit_ceil(std::max<std::size_t>(capacity, 2))),
+        m_mask(m_slots.size() - 1)
+   {}
+
+   SpscQueue(const SpscQueue&) = delete;
+   SpscQueue& operator=(const SpscQueue&) = delete;
+
+   bool TryPush(const T& value)
+   {
+      const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+      if (tail - m_cachedHead == m_slots.size())
+      {
+         m_cachedHead = m_head.load(std::memory_order_acquire);
+         if (tail - m_cachedHead == m_slots.size())
+            return false;
+      }
+
+      m_slots[tail & m_mask] = value;
+      m_tail.store(tail + 1, std::memory_order_release);
+      return true;
+   }
+
+   bool TryPop(T& value)
+   {
+      const std::size_t head = m_head.load(std::memory_order_relaxed);
+
+      if (head == m_cachedTail)
+      {
+         m_cachedTail = m_tail.load(std::memory_order_acquire);
+         if (head == m_cachedTail)
+            return false;
+      }
+
+      value = m_slots[head & m_mask];
+      m_head.store(head + 1, std::memory_order_release);
+      return true;
+   }
+
+   bool empty() const
+   {
+      return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+   }
+
+   std::size_t capacity() const { return m_slots.size(); }
+
+   // Running totals of items ever pushed / popped. Comparing a recorded
+   // pushed count against the popped count tells the consumer when every
+   // item enqueued before a point in time has been taken.
+   std::size_t GetPushedCount() const { return m_tail.load(std::memory_order_acquire); }
+   std::size_t GetPoppedCount() const { return m_head.load(std::memory_order_acquire); }
+
+private:
+   static constexpr std::size_t CacheLine = 64;
+
+   std::vector<T> m_slots;
+   std::size_t m_mask;
+
+   alignas(CacheLine) std::atomic<std::size_t> m_head{0};
+   std::size_t m_cachedTail = 0;    // consumer's view of m_tail
+
+   alignas(CacheLine) std::atomic<std::size_t> m_tail{0};
+   std::size_t m_cachedHead = 0;    // producer's view of m_head
+};
@@ -23,10 +23,10 @@ int main() {
     Orderbook book;
     
     std::cout << "=== TEST 1: Basic Limit Orders ===" << std::endl;
-    Order limitSell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
-    Order limitSell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 30);
-    Order limitBuy1(OrderType::GoodTillCancel, 3, 99.0, Side::Buy, 40);
-    Order limitBuy2(OrderType::GoodTillCancel, 4, 98.0, Side::Buy, 20);
+    Order limitSell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
+    Order limitSell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 30);
+    Order limitBuy1(OrderType::GoodTillCancel, 3, 99, Side::Buy, 40);
+    Order limitBuy2(OrderType::GoodTillCancel, 4, 98, Side::Buy, 20);
     
     PrintOutcome("Sell@100x50", book.ExecuteTrade(limitSell1));  // Should add to book
     PrintOutcome("Sell@101x30", book.ExecuteTrade(limitSell2));  // Should add to book
@@ -42,42 +42,42 @@ int main() {
     PrintOutcome("Market Buy x100", book.ExecuteTrade(marketBuy2)); // Partially filled (only 30 left at 101)
     
     std::cout << "\n=== TEST 4: Limit Order - Immediate Fill ===" << std::endl;
-    Order limitSell3(OrderType::GoodTillCancel, 7, 97.0, Side::Sell, 25);
+    Order limitSell3(OrderType::GoodTillCancel, 7, 97, Side::Sell, 25);
     PrintOutcome("Sell@97x25", book.ExecuteTrade(limitSell3)); // Should fill against buy@99
     
     std::cout << "\n=== TEST 5: IOC - Full Fill ===" << std::endl;
-    Order limitSell4(OrderType::GoodTillCancel, 8, 100.0, Side::Sell, 20);
+    Order limitSell4(OrderType::GoodTillCancel, 8, 100, Side::Sell, 20);
     book.ExecuteTrade(limitSell4); // Add some asks back
     
-    Order iocBuy1(OrderType::ImmediateOrCancel, 9, 100.0, Side::Buy, 20);
+    Order iocBuy1(OrderType::ImmediateOrCancel, 9, 100, Side::Buy, 20);
     PrintOutcome("IOC Buy@100x20", book.ExecuteTrade(iocBuy1)); // Should fully fill
     
     std::cout << "\n=== TEST 6: IOC - Partial Fill ===" << std::endl;
-    Order limitSell5(OrderType::GoodTillCancel, 10, 101.0, Side::Sell, 10);
+    Order limitSell5(OrderType::GoodTillCancel, 10, 101, Side::Sell, 10);
     book.ExecuteTrade(limitSell5);
     
-    Order iocBuy2(OrderType::ImmediateOrCancel, 11, 101.0, Side::Buy, 50);
+    Order iocBuy2(OrderType::ImmediateOrCancel, 11, 101, Side::Buy, 50);
     PrintOutcome("IOC Buy@101x50", book.ExecuteTrade(iocBuy2)); // Partial fill, cancel rest
     
     std::cout << "\n=== TEST 7: Fill-or-Kill - Success ===" << std::endl;
-    Order limitSell6(OrderType::GoodTillCancel, 12, 102.0, Side::Sell, 100);
+    Order limitSell6(OrderType::GoodTillCancel, 12, 102, Side::Sell, 100);
     book.ExecuteTrade(limitSell6);
     
-    Order fokBuy1(OrderType::FillOrKill, 13, 102.0, Side::Buy, 100);
+    Order fokBuy1(OrderType::FillOrKill, 13, 102, Side::Buy, 100);
     PrintOutcome("FOK Buy@102x100", book.ExecuteTrade(fokBuy1)); // Should fully fill
     
     std::cout << "\n=== TEST 8: Fill-or-Kill - Failure ===" << std::endl;
-    Order limitSell7(OrderType::GoodTillCancel, 14, 103.0, Side::Sell, 50);
+    Order limitSell7(OrderType::GoodTillCancel, 14, 103, Side::Sell, 50);
     book.ExecuteTrade(limitSell7);
     
-    Order fokBuy2(OrderType::FillOrKill, 15, 103.0, Side::Buy, 200);
+    Order fokBuy2(OrderType::FillOrKill, 15, 103, Side::Buy, 200);
     PrintOutcome("FOK Buy@103x200", book.ExecuteTrade(fokBuy2)); // Should cancel (not enough volume)
     
     std::cout << "\n=== TEST 9: Order Modification ===" << std::endl;
-    Order limitBuy3(OrderType::GoodTillCancel, 16, 95.0, Side::Buy, 100);
+    Order limitBuy3(OrderType::GoodTillCancel, 16, 95, Side::Buy, 100);
     book.ExecuteTrade(limitBuy3);
     
-    bool modSuccess = book.ModifyOrder(16, 96.0, 80);
+    bool modSuccess = book.ModifyOrder(16, 96, 80);
     std::cout << "Modify Order 16 (price 95->96, vol 100->80): " 
               << (modSuccess ? "Success" : "Failed") << std::endl;
     
@@ -0,0 +1,30 @@
+#pragma once
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Pins the calling thread to one CPU core. Returns false if the platform
+// refuses or does not support it; callers treat pinning as best effort.
+inline bool PinCurrentThread(const int core)
+{
+   if (core < 0)
+      return false;
+
+#if defined(_WIN32)
+   return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+#elif defined(__linux__)
+   cpu_set_t cpus;
+   CPU_ZERO(&cpus);
+   CPU_SET(core, &cpus);
+   return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+   return false;
+#endif
+}
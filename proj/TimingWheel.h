@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "OrderDetails.h"
+
+// Index a TimingWheel knows a node by, and the index of no node.
+using TimerIndex = std::uint32_t;
+inline constexpr TimerIndex NoTimer = std::numeric_limits<TimerIndex>::max();
+
+// Intrusive hook a node embeds to be scheduled on a TimingWheel. Nodes are
+// linked by index rather than address, so the array holding them may grow
+// and move. bucket is the wheel slot the node sits in, so a node at the
+// head of its slot unlinks itself without a search.
+struct TimerLink
+{
+   TimerIndex next = NoTimer;
+   TimerIndex previous = NoTimer;
+   std::uint16_t bucket = NoBucket;
+   Timestamp deadline = 0;
+
+   static constexpr std::uint16_t NoBucket = std::numeric_limits<std::uint16_t>::max();
+
+   bool IsScheduled() const { return bucket != NoBucket; }
+};
+
+// Hierarchical timing wheel over intrusively linked nodes. Each level has
+// 64 slots, one per 6-bit digit of the deadline; a node sits at the level
+// of the highest digit in which its deadline differs from the current
+// time, and moves down a level each time the clock enters its slot. With
+// 11 levels every 64-bit deadline fits, so nothing is ever parked in an
+// overflow list.
+//
+// Schedule and Cancel are O(1). Advance jumps straight to the start of
+// the next occupied slot using one occupancy mask per level, so its cost
+// is the nodes expired plus the cascades they need, however far the
+// clock moves.
+//
+// The wheel holds no nodes itself: every call that touches them takes
+// nodes, a callable returning the Node for a TimerIndex.
+template <typename Node, TimerLink Node::*Link>
+class TimingWheel
+{
+public:
+   TimingWheel()
+   {
+      for (auto& level : slots)
+         level.fill(NoTimer);
+   }
+
+   bool empty() const { return count == 0; }
+   std::size_t size() const { return count; }
+   Timestamp Now() const { return now; }
+
+   // Moves an empty wheel's clock to time; a wheel holding nodes only
+   // moves forward through Advance.
+   void Reset(const Timestamp time)
+   {
+      if (count == 0)
+         now = time;
+   }
+
+   // Schedules node index to expire at deadline, which must be after Now().
+   template <typename Nodes>
+   void Schedule(Nodes&& nodes, const TimerIndex index, const Timestamp deadline)
+   {
+      (nodes(index).*Link).deadline = deadline;
+      Insert(nodes, index);
+      ++count;
+   }
+
+   // Unschedules node index; does nothing if it is not scheduled.
+   template <typename Nodes>
+   void Cancel(Nodes&& nodes, const TimerIndex index)
+   {
+      if (!(nodes(index).*Link).IsScheduled())
+         return;
+
+      Unlink(nodes, index);
+      --count;
+   }
+
+   // Moves the clock to time, handing every node whose deadline has been
+   // reached to expire, in deadline order. A node is unscheduled before
+   // expire sees it, so expire may release it.
+   template <typename Nodes, typename Visitor>
+   void Advance(Nodes&& nodes, const Timestamp time, Visitor&& expire)
+   {
+      while (count != 0)
+      {
+         const Timestamp next = NextSlotStart();
+         if (next > time)
+            break;
+
+         now = next;
+         Cascade(nodes);
+
+         const TimerIndex& due = slots[0][now & SlotMask];
+         while (due != NoTimer)
+         {
+            const TimerIndex index = due;
+            Unlink(nodes, index);
+            --count;
+            expire(nodes(index));
+         }
+         masks[0] &= ~(std::uint64_t{1} << (now & SlotMask));
+      }
+
+      if (time > now)
+         now = time;
+   }
+
+private:
+   static constexpr unsigned SlotBits = 6;
+   static constexpr std::size_t SlotsPerLevel = std::size_t{1} << SlotBits;
+   static constexpr Timestamp SlotMask = SlotsPerLevel - 1;
+   static constexpr std::size_t Levels = (64 + SlotBits - 1) / SlotBits;
+
+   std::array<std::array<TimerIndex, SlotsPerLevel>, Levels> slots;
+   std::array<std::uint64_t, Levels> masks{};
+   Timestamp now = 0;
+   std::size_t count = 0;
+
+   static unsigned Shift(const std::size_t level) { return static_cast<unsigned>(level * SlotBits); }
+
+   static std::size_t SlotAt(const Timestamp time, const std::size_t level)
+   {
+      return static_cast<std::size_t>((time >> Shift(level)) & SlotMask);
+   }
+
+   // time with every digit from level down cleared.
+   static Timestamp LevelBase(const Timestamp time, const std::size_t level)
+   {
+      const unsigned shift = Shift(level + 1);
+      return shift >= 64 ? 0 : (time >> shift) << shift;
+   }
+
+   // Places a node by the highest digit its deadline shares no more with
+   // now. A deadline equal to now (only seen while cascading) goes to the
+   // current level-0 slot, which Advance is about to expire.
+   template <typename Nodes>
+   void Insert(Nodes& nodes, const TimerIndex index)
+   {
+      TimerLink& link = nodes(index).*Link;
+      const Timestamp deadline = link.deadline;
+      const std::size_t level = (deadline == now)
+                                   ? 0
+                                   : static_cast<std::size_t>(std::bit_width(deadline ^ now) - 1) / SlotBits;
+      const std::size_t slot = SlotAt(deadline, level);
+
+      TimerIndex& head = slots[level][slot];
+      link.next = head;
+      link.previous = NoTimer;
+      link.bucket = static_cast<std::uint16_t>(level * SlotsPerLevel + slot);
+      if (head != NoTimer)
+         (nodes(head).*Link).previous = index;
+      head = index;
+      masks[level] |= std::uint64_t{1} << slot;
+   }
+
+   // The level mask is left set when a slot empties this way; it is
+   // cleared once the slot is visited and found empty.
+   template <typename Nodes>
+   void Unlink(Nodes& nodes, const TimerIndex index)
+   {
+      TimerLink& link = nodes(index).*Link;
+      if (link.previous != NoTimer)
+         (nodes(link.previous).*Link).next = link.next;
+      else
+         slots[link.bucket / SlotsPerLevel][link.bucket % SlotsPerLevel] = link.next;
+      if (link.next != NoTimer)
+         (nodes(link.next).*Link).previous = link.previous;
+      link.next = NoTimer;
+      link.previous = NoTimer;
+      link.bucket = TimerLink::NoBucket;
+   }
+
+   // Earliest time at which an occupied slot on any level begins. Occupied
+   // slots always lie ahead of now's digit on their level.
+   Timestamp NextSlotStart() const
+   {
+      Timestamp next = std::numeric_limits<Timestamp>::max();
+
+      for (std::size_t level = 0; level < Levels; ++level)
+      {
+         const std::size_t current = SlotAt(now, level);
+         const std::uint64_t ahead = (current + 1 == SlotsPerLevel) ? 0
+                                                                    : masks[level] & (~std::uint64_t{0} << (current + 1));
+         // The current level-0 slot is still due until Advance clears it.
+         const std::uint64_t due = (level == 0) ? masks[0] & (std::uint64_t{1} << current) : 0;
+
+         if (due)
+            return now;
+         if (ahead)
+         {
+            const Timestamp start = LevelBase(now, level)
+                                  + (static_cast<Timestamp>(std::countr_zero(ahead)) << Shift(level));
+            if (start < next)
+               next = start;
+         }
+      }
+      return next;
+   }
+
+   // On arriving at the start of a slot, spreads the nodes of every
+   // higher-level slot that begins here over the levels below, top first
+   // so a node can fall through several levels in one step.
+   template <typename Nodes>
+   void Cascade(Nodes& nodes)
+   {
+      for (std::size_t level = Levels - 1; level > 0; --level)
+      {
+         if (LevelBase(now, level - 1) != now)
+            continue;
+
+         const std::size_t slot = SlotAt(now, level);
+         TimerIndex index = slots[level][slot];
+         slots[level][slot] = NoTimer;
+         masks[level] &= ~(std::uint64_t{1} << slot);
+
+         while (index != NoTimer)
+         {
+            const TimerIndex next = (nodes(index).*Link).next;
+            Insert(nodes, index);
+            index = next;
+         }
+      }
+   }
+};
@@ -1,12 +1,23 @@
 #include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
 #include "OrderBook.h"
+#include "MatchingEngine.h"
+#include "MultiInstrumentEngine.h"
+#include "Journal.h"
+#include "L3Feed.h"
+#include "MessageReplay.h"
 
 // ==================== BASIC LIMIT ORDER TESTS ====================
 
 // Test: Buy limit order added to empty book
 TEST(OrderbookTest, BuyLimitOrderAddedToEmptyBook) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    
    OrderOutcome result = book.ExecuteTrade(order);
    
@@ -16,7 +27,7 @@ TEST(OrderbookTest, BuyLimitOrderAddedToEmptyBook) {
 // Test: Sell limit order added to empty book
 TEST(OrderbookTest, SellLimitOrderAddedToEmptyBook) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    
    OrderOutcome result = book.ExecuteTrade(order);
    
@@ -26,10 +37,10 @@ TEST(OrderbookTest, SellLimitOrderAddedToEmptyBook) {
 // Test: Buy limit order added when price below best ask
 TEST(OrderbookTest, BuyLimitOrderAddedWhenBelowBestAsk) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::GoodTillCancel, 2, 99.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 2, 99, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::AddedToOrderbook);
@@ -38,10 +49,10 @@ TEST(OrderbookTest, BuyLimitOrderAddedWhenBelowBestAsk) {
 // Test: Sell limit order added when price above best bid
 TEST(OrderbookTest, SellLimitOrderAddedWhenAboveBestBid) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 2, 101, Side::Sell, 50);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::AddedToOrderbook);
@@ -52,10 +63,10 @@ TEST(OrderbookTest, SellLimitOrderAddedWhenAboveBestBid) {
 // Test: Buy limit order immediately fills when price at best ask
 TEST(OrderbookTest, BuyLimitOrderImmediatelyFillsAtBestAsk) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::GoodTillCancel, 2, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 2, 100, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -64,10 +75,10 @@ TEST(OrderbookTest, BuyLimitOrderImmediatelyFillsAtBestAsk) {
 // Test: Buy limit order immediately fills when price above best ask
 TEST(OrderbookTest, BuyLimitOrderImmediatelyFillsAboveBestAsk) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::GoodTillCancel, 2, 105.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 2, 105, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -76,10 +87,10 @@ TEST(OrderbookTest, BuyLimitOrderImmediatelyFillsAboveBestAsk) {
 // Test: Sell limit order immediately fills when price at best bid
 TEST(OrderbookTest, SellLimitOrderImmediatelyFillsAtBestBid) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::GoodTillCancel, 2, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 2, 100, Side::Sell, 50);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -88,10 +99,10 @@ TEST(OrderbookTest, SellLimitOrderImmediatelyFillsAtBestBid) {
 // Test: Sell limit order immediately fills when price below best bid
 TEST(OrderbookTest, SellLimitOrderImmediatelyFillsBelowBestBid) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::GoodTillCancel, 2, 95.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 2, 95, Side::Sell, 50);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -100,10 +111,10 @@ TEST(OrderbookTest, SellLimitOrderImmediatelyFillsBelowBestBid) {
 // Test: Limit order partially fills and remainder added to book
 TEST(OrderbookTest, LimitOrderPartiallyFilledAndAddedToBook) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::GoodTillCancel, 2, 100.0, Side::Buy, 80);
+   Order buy(OrderType::GoodTillCancel, 2, 100, Side::Buy, 80);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndAddedToBook);
@@ -112,12 +123,12 @@ TEST(OrderbookTest, LimitOrderPartiallyFilledAndAddedToBook) {
 // Test: Limit order consumes multiple price levels and fully fills
 TEST(OrderbookTest, LimitOrderConsumesMultipleLevelsFullyFills) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
-   Order buy(OrderType::GoodTillCancel, 3, 101.0, Side::Buy, 70);
+   Order buy(OrderType::GoodTillCancel, 3, 101, Side::Buy, 70);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -126,12 +137,12 @@ TEST(OrderbookTest, LimitOrderConsumesMultipleLevelsFullyFills) {
 // Test: Limit order consumes multiple price levels and partially fills
 TEST(OrderbookTest, LimitOrderConsumesMultipleLevelsPartiallyFills) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
-   Order buy(OrderType::GoodTillCancel, 3, 101.0, Side::Buy, 100);
+   Order buy(OrderType::GoodTillCancel, 3, 101, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndAddedToBook);
@@ -140,14 +151,14 @@ TEST(OrderbookTest, LimitOrderConsumesMultipleLevelsPartiallyFills) {
 // Test: Limit order stops at price limit boundary
 TEST(OrderbookTest, LimitOrderStopsAtPriceLimit) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
-   Order sell3(OrderType::GoodTillCancel, 3, 102.0, Side::Sell, 50);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
+   Order sell3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 50);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
    
-   Order buy(OrderType::GoodTillCancel, 4, 101.0, Side::Buy, 100);
+   Order buy(OrderType::GoodTillCancel, 4, 101, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndAddedToBook);
@@ -158,7 +169,7 @@ TEST(OrderbookTest, LimitOrderStopsAtPriceLimit) {
 // Test: Market buy order fully fills against single resting order
 TEST(OrderbookTest, MarketBuyOrderFullyFillsSingleLevel) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 50);
@@ -170,7 +181,7 @@ TEST(OrderbookTest, MarketBuyOrderFullyFillsSingleLevel) {
 // Test: Market sell order fully fills against single resting order
 TEST(OrderbookTest, MarketSellOrderFullyFillsSingleLevel) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
    Order sell(OrderType::Market, 2, 0, Side::Sell, 50);
@@ -182,7 +193,7 @@ TEST(OrderbookTest, MarketSellOrderFullyFillsSingleLevel) {
 // Test: Market order partially fills when insufficient volume available
 TEST(OrderbookTest, MarketOrderPartiallyFilledInsufficientVolume) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 100);
@@ -214,8 +225,8 @@ TEST(OrderbookTest, MarketSellOrderCancelledWhenBidsEmpty) {
 // Test: Market order consumes multiple price levels
 TEST(OrderbookTest, MarketOrderConsumesMultipleLevels) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
@@ -228,9 +239,9 @@ TEST(OrderbookTest, MarketOrderConsumesMultipleLevels) {
 // Test: Market order exhausts all available liquidity
 TEST(OrderbookTest, MarketOrderExhaustsAllLiquidity) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 20);
-   Order sell3(OrderType::GoodTillCancel, 3, 102.0, Side::Sell, 25);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 20);
+   Order sell3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 25);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
@@ -244,7 +255,7 @@ TEST(OrderbookTest, MarketOrderExhaustsAllLiquidity) {
 // Test: Market order partially fills resting order at price level
 TEST(OrderbookTest, MarketOrderPartiallyFillsRestingOrder) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 100);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 100);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 60);
@@ -258,10 +269,10 @@ TEST(OrderbookTest, MarketOrderPartiallyFillsRestingOrder) {
 // Test: IOC buy order fully fills at limit price
 TEST(OrderbookTest, IOCBuyOrderFullyFillsAtLimit) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::ImmediateOrCancel, 2, 100.0, Side::Buy, 50);
+   Order buy(OrderType::ImmediateOrCancel, 2, 100, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -270,10 +281,10 @@ TEST(OrderbookTest, IOCBuyOrderFullyFillsAtLimit) {
 // Test: IOC sell order fully fills at limit price
 TEST(OrderbookTest, IOCSellOrderFullyFillsAtLimit) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::ImmediateOrCancel, 2, 100.0, Side::Sell, 50);
+   Order sell(OrderType::ImmediateOrCancel, 2, 100, Side::Sell, 50);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -282,10 +293,10 @@ TEST(OrderbookTest, IOCSellOrderFullyFillsAtLimit) {
 // Test: IOC order partially fills and cancels remainder
 TEST(OrderbookTest, IOCOrderPartiallyFillsCancelsRemainder) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::ImmediateOrCancel, 2, 100.0, Side::Buy, 80);
+   Order buy(OrderType::ImmediateOrCancel, 2, 100, Side::Buy, 80);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndCancelled);
@@ -294,10 +305,10 @@ TEST(OrderbookTest, IOCOrderPartiallyFillsCancelsRemainder) {
 // Test: IOC buy order cancelled when price below best ask
 TEST(OrderbookTest, IOCBuyOrderCancelledWhenPriceBelowBestAsk) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 101.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 101, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::ImmediateOrCancel, 2, 99.0, Side::Buy, 50);
+   Order buy(OrderType::ImmediateOrCancel, 2, 99, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::Cancelled);
@@ -306,10 +317,10 @@ TEST(OrderbookTest, IOCBuyOrderCancelledWhenPriceBelowBestAsk) {
 // Test: IOC sell order cancelled when price above best bid
 TEST(OrderbookTest, IOCSellOrderCancelledWhenPriceAboveBestBid) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 99.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 99, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::ImmediateOrCancel, 2, 101.0, Side::Sell, 50);
+   Order sell(OrderType::ImmediateOrCancel, 2, 101, Side::Sell, 50);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::Cancelled);
@@ -318,12 +329,12 @@ TEST(OrderbookTest, IOCSellOrderCancelledWhenPriceAboveBestBid) {
 // Test: IOC order consumes multiple price levels within limit
 TEST(OrderbookTest, IOCOrderConsumesMultipleLevelsWithinLimit) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
-   Order buy(OrderType::ImmediateOrCancel, 3, 101.0, Side::Buy, 70);
+   Order buy(OrderType::ImmediateOrCancel, 3, 101, Side::Buy, 70);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -332,14 +343,14 @@ TEST(OrderbookTest, IOCOrderConsumesMultipleLevelsWithinLimit) {
 // Test: IOC order stops at price limit with partial fill
 TEST(OrderbookTest, IOCOrderStopsAtPriceLimitPartialFill) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
-   Order sell3(OrderType::GoodTillCancel, 3, 102.0, Side::Sell, 50);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
+   Order sell3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 50);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
    
-   Order buy(OrderType::ImmediateOrCancel, 4, 101.0, Side::Buy, 100);
+   Order buy(OrderType::ImmediateOrCancel, 4, 101, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndCancelled);
@@ -350,10 +361,10 @@ TEST(OrderbookTest, IOCOrderStopsAtPriceLimitPartialFill) {
 // Test: FOK buy order executes when sufficient volume available at single level
 TEST(OrderbookTest, FOKBuyOrderExecutesSufficientVolumeSingleLevel) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 100);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 100);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::FillOrKill, 2, 100.0, Side::Buy, 100);
+   Order buy(OrderType::FillOrKill, 2, 100, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -362,10 +373,10 @@ TEST(OrderbookTest, FOKBuyOrderExecutesSufficientVolumeSingleLevel) {
 // Test: FOK sell order executes when sufficient volume available at single level
 TEST(OrderbookTest, FOKSellOrderExecutesSufficientVolumeSingleLevel) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 100);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 100);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::FillOrKill, 2, 100.0, Side::Sell, 100);
+   Order sell(OrderType::FillOrKill, 2, 100, Side::Sell, 100);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -374,12 +385,12 @@ TEST(OrderbookTest, FOKSellOrderExecutesSufficientVolumeSingleLevel) {
 // Test: FOK order executes when sufficient volume across multiple levels
 TEST(OrderbookTest, FOKOrderExecutesSufficientVolumeMultipleLevels) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 60);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 60);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
-   Order buy(OrderType::FillOrKill, 3, 101.0, Side::Buy, 100);
+   Order buy(OrderType::FillOrKill, 3, 101, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -388,10 +399,10 @@ TEST(OrderbookTest, FOKOrderExecutesSufficientVolumeMultipleLevels) {
 // Test: FOK buy order cancelled when insufficient volume
 TEST(OrderbookTest, FOKBuyOrderCancelledInsufficientVolume) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
-   Order buy(OrderType::FillOrKill, 2, 100.0, Side::Buy, 100);
+   Order buy(OrderType::FillOrKill, 2, 100, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::Cancelled);
@@ -400,10 +411,10 @@ TEST(OrderbookTest, FOKBuyOrderCancelledInsufficientVolume) {
 // Test: FOK sell order cancelled when insufficient volume
 TEST(OrderbookTest, FOKSellOrderCancelledInsufficientVolume) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::FillOrKill, 2, 100.0, Side::Sell, 100);
+   Order sell(OrderType::FillOrKill, 2, 100, Side::Sell, 100);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::Cancelled);
@@ -412,12 +423,12 @@ TEST(OrderbookTest, FOKSellOrderCancelledInsufficientVolume) {
 // Test: FOK order cancelled when volume exists but outside price limit
 TEST(OrderbookTest, FOKOrderCancelledVolumeOutsidePriceLimit) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
-   Order sell2(OrderType::GoodTillCancel, 2, 102.0, Side::Sell, 60);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
+   Order sell2(OrderType::GoodTillCancel, 2, 102, Side::Sell, 60);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
-   Order buy(OrderType::FillOrKill, 3, 101.0, Side::Buy, 100);
+   Order buy(OrderType::FillOrKill, 3, 101, Side::Buy, 100);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::Cancelled);
@@ -428,9 +439,9 @@ TEST(OrderbookTest, FOKOrderCancelledVolumeOutsidePriceLimit) {
 // Test: Orders at same price level execute in FIFO order
 TEST(OrderbookTest, PriceTimePriorityFIFOAtSameLevel) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 100.0, Side::Sell, 20);
-   Order sell3(OrderType::GoodTillCancel, 3, 100.0, Side::Sell, 10);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 100, Side::Sell, 20);
+   Order sell3(OrderType::GoodTillCancel, 3, 100, Side::Sell, 10);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
@@ -444,9 +455,9 @@ TEST(OrderbookTest, PriceTimePriorityFIFOAtSameLevel) {
 // Test: Best price executes before worse price
 TEST(OrderbookTest, BestPriceExecutesFirst) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 101.0, Side::Sell, 50);
-   Order sell2(OrderType::GoodTillCancel, 2, 100.0, Side::Sell, 50);
-   Order sell3(OrderType::GoodTillCancel, 3, 102.0, Side::Sell, 50);
+   Order sell1(OrderType::GoodTillCancel, 1, 101, Side::Sell, 50);
+   Order sell2(OrderType::GoodTillCancel, 2, 100, Side::Sell, 50);
+   Order sell3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 50);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
@@ -462,10 +473,10 @@ TEST(OrderbookTest, BestPriceExecutesFirst) {
 // Test: Modify order volume decrease succeeds
 TEST(OrderbookTest, ModifyOrderVolumeDecreaseSucceeds) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 100);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 100);
    book.ExecuteTrade(order);
    
-   bool result = book.ModifyOrder(1, 100.0, 50);
+   bool result = book.ModifyOrder(1, 100, 50);
    
    EXPECT_TRUE(result);
 }
@@ -473,10 +484,10 @@ TEST(OrderbookTest, ModifyOrderVolumeDecreaseSucceeds) {
 // Test: Modify order price change succeeds for buy order
 TEST(OrderbookTest, ModifyBuyOrderPriceChangeSucceeds) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(order);
    
-   bool result = book.ModifyOrder(1, 95.0, 50);
+   bool result = book.ModifyOrder(1, 95, 50);
    
    EXPECT_TRUE(result);
 }
@@ -484,10 +495,10 @@ TEST(OrderbookTest, ModifyBuyOrderPriceChangeSucceeds) {
 // Test: Modify order price change succeeds for sell order
 TEST(OrderbookTest, ModifySellOrderPriceChangeSucceeds) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(order);
    
-   bool result = book.ModifyOrder(1, 105.0, 50);
+   bool result = book.ModifyOrder(1, 105, 50);
    
    EXPECT_TRUE(result);
 }
@@ -495,10 +506,10 @@ TEST(OrderbookTest, ModifySellOrderPriceChangeSucceeds) {
 // Test: Modify order with both price and volume change succeeds
 TEST(OrderbookTest, ModifyOrderPriceAndVolumeChangeSucceeds) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 100);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 100);
    book.ExecuteTrade(order);
    
-   bool result = book.ModifyOrder(1, 95.0, 50);
+   bool result = book.ModifyOrder(1, 95, 50);
    
    EXPECT_TRUE(result);
 }
@@ -507,7 +518,7 @@ TEST(OrderbookTest, ModifyOrderPriceAndVolumeChangeSucceeds) {
 TEST(OrderbookTest, ModifyOrderFailsForNonExistentOrder) {
    Orderbook book;
    
-   bool result = book.ModifyOrder(999, 100.0, 50);
+   bool result = book.ModifyOrder(999, 100, 50);
    
    EXPECT_FALSE(result);
 }
@@ -515,10 +526,10 @@ TEST(OrderbookTest, ModifyOrderFailsForNonExistentOrder) {
 // Test: Modify order with zero volume cancels order
 TEST(OrderbookTest, ModifyOrderZeroVolumeCancelsOrder) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(order);
    
-   bool result = book.ModifyOrder(1, 100.0, 0);
+   bool result = book.ModifyOrder(1, 100, 0);
    
    EXPECT_TRUE(result);
 }
@@ -526,10 +537,10 @@ TEST(OrderbookTest, ModifyOrderZeroVolumeCancelsOrder) {
 // Test: Modify order with negative volume cancels order
 TEST(OrderbookTest, ModifyOrderNegativeVolumeCancelsOrder) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(order);
    
-   bool result = book.ModifyOrder(1, 100.0, -10);
+   bool result = book.ModifyOrder(1, 100, -10);
    
    EXPECT_TRUE(result);
 }
@@ -537,7 +548,7 @@ TEST(OrderbookTest, ModifyOrderNegativeVolumeCancelsOrder) {
 // Test: Cannot modify order to increase volume
 TEST(OrderbookTest, ModifyOrderCannotIncreaseVolume) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(order);
    
    bool result = book.ModifyVolume(order, 100);
@@ -548,23 +559,67 @@ TEST(OrderbookTest, ModifyOrderCannotIncreaseVolume) {
 // Test: Modify order that was partially filled
 TEST(OrderbookTest, ModifyPartiallyFilledOrder) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 100);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 100);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 60);
    book.ExecuteTrade(buy);
    
-   bool result = book.ModifyOrder(1, 100.0, 20);
+   bool result = book.ModifyOrder(1, 100, 20);
    
    EXPECT_TRUE(result);
 }
 
+// Test: A volume cut keeps queue priority, an increase requeues at the back
+TEST(OrderbookTest, ModifyOrderVolumeIncreaseRequeues) {
+   Orderbook book;
+   Order first(OrderType::GoodTillCancel, 1, 100, Side::Buy, 10);
+   Order second(OrderType::GoodTillCancel, 2, 100, Side::Buy, 10);
+   book.ExecuteTrade(first);
+   book.ExecuteTrade(second);
+
+   EXPECT_TRUE(book.ModifyOrder(1, 100, 8));
+   Order sell(OrderType::Market, 3, 0, Side::Sell, 3);
+   book.ExecuteTrade(sell);
+   EXPECT_EQ(book.FindOrder(1)->GetRemainingVolume(), 5);
+   EXPECT_EQ(book.FindOrder(2)->GetRemainingVolume(), 10);
+
+   EXPECT_TRUE(book.ModifyOrder(1, 100, 20));
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 100), 30);
+   Order sellAgain(OrderType::Market, 4, 0, Side::Sell, 12);
+   book.ExecuteTrade(sellAgain);
+   EXPECT_FALSE(book.FindOrder(2).has_value());
+   EXPECT_EQ(book.FindOrder(1)->GetRemainingVolume(), 18);
+}
+
+// Test: Repricing through the opposite touch trades before resting
+TEST(OrderbookTest, ModifyOrderToMarketablePriceMatches) {
+   Orderbook book;
+   Order ask(OrderType::GoodTillCancel, 1, 101, Side::Sell, 5);
+   Order bid(OrderType::GoodTillCancel, 2, 100, Side::Buy, 10);
+   book.ExecuteTrade(ask);
+   book.ExecuteTrade(bid);
+   book.GetExecutionEvents().Clear();
+
+   EXPECT_TRUE(book.ModifyOrder(2, 102, 10));
+   EXPECT_FALSE(book.FindOrder(1).has_value());
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 100), 0);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 102), 5);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 101), 0u);
+
+   const auto& events = book.GetExecutionEvents();
+   ASSERT_EQ(events.size(), 2u);
+   EXPECT_EQ(events[0].type, ExecutionEventType::Modified);
+   EXPECT_EQ(events[1].type, ExecutionEventType::Fill);
+   EXPECT_EQ(events[1].price, 101);
+}
+
 // ==================== ORDER CANCELLATION TESTS ====================
 
 // Test: Cancel buy order succeeds
 TEST(OrderbookTest, CancelBuyOrderSucceeds) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(order);
    
    bool result = book.CancelOrder(1);
@@ -575,7 +630,7 @@ TEST(OrderbookTest, CancelBuyOrderSucceeds) {
 // Test: Cancel sell order succeeds
 TEST(OrderbookTest, CancelSellOrderSucceeds) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(order);
    
    bool result = book.CancelOrder(1);
@@ -595,7 +650,7 @@ TEST(OrderbookTest, CancelOrderFailsForNonExistentOrder) {
 // Test: Cancel order fails for already filled order
 TEST(OrderbookTest, CancelOrderFailsForFilledOrder) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 50);
@@ -609,7 +664,7 @@ TEST(OrderbookTest, CancelOrderFailsForFilledOrder) {
 // Test: Cancel partially filled order succeeds
 TEST(OrderbookTest, CancelPartiallyFilledOrderSucceeds) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 100);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 100);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 60);
@@ -645,7 +700,7 @@ TEST(OrderbookTest, OrderWithZeroVolumeRejected) {
 // Test: Limit order with zero volume is rejected
 TEST(OrderbookTest, LimitOrderWithZeroVolumeRejected) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 0);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 0);
    
    OrderOutcome result = book.ExecuteTrade(order);
    
@@ -655,7 +710,7 @@ TEST(OrderbookTest, LimitOrderWithZeroVolumeRejected) {
 // Test: IOC order with zero volume is rejected
 TEST(OrderbookTest, IOCOrderWithZeroVolumeRejected) {
    Orderbook book;
-   Order order(OrderType::ImmediateOrCancel, 1, 100.0, Side::Buy, 0);
+   Order order(OrderType::ImmediateOrCancel, 1, 100, Side::Buy, 0);
    
    OrderOutcome result = book.ExecuteTrade(order);
    
@@ -665,7 +720,7 @@ TEST(OrderbookTest, IOCOrderWithZeroVolumeRejected) {
 // Test: FOK order with zero volume is rejected
 TEST(OrderbookTest, FOKOrderWithZeroVolumeRejected) {
    Orderbook book;
-   Order order(OrderType::FillOrKill, 1, 100.0, Side::Buy, 0);
+   Order order(OrderType::FillOrKill, 1, 100, Side::Buy, 0);
    
    OrderOutcome result = book.ExecuteTrade(order);
    
@@ -677,9 +732,9 @@ TEST(OrderbookTest, FOKOrderWithZeroVolumeRejected) {
 // Test: Multiple orders at same price maintain FIFO with partial fills
 TEST(OrderbookTest, MultipleSamePriceOrdersFIFOPartialFill) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 40);
-   Order sell2(OrderType::GoodTillCancel, 2, 100.0, Side::Sell, 30);
-   Order sell3(OrderType::GoodTillCancel, 3, 100.0, Side::Sell, 20);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 40);
+   Order sell2(OrderType::GoodTillCancel, 2, 100, Side::Sell, 30);
+   Order sell3(OrderType::GoodTillCancel, 3, 100, Side::Sell, 20);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
@@ -693,10 +748,10 @@ TEST(OrderbookTest, MultipleSamePriceOrdersFIFOPartialFill) {
 // Test: Large order sweeps entire book
 TEST(OrderbookTest, LargeOrderSweepsEntireBook) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 50);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 50);
-   Order sell3(OrderType::GoodTillCancel, 3, 102.0, Side::Sell, 50);
-   Order sell4(OrderType::GoodTillCancel, 4, 103.0, Side::Sell, 50);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 50);
+   Order sell3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 50);
+   Order sell4(OrderType::GoodTillCancel, 4, 103, Side::Sell, 50);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
@@ -711,9 +766,9 @@ TEST(OrderbookTest, LargeOrderSweepsEntireBook) {
 // Test: Order exactly matches available liquidity
 TEST(OrderbookTest, OrderExactlyMatchesAvailableLiquidity) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 45);
-   Order sell3(OrderType::GoodTillCancel, 3, 102.0, Side::Sell, 25);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 45);
+   Order sell3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 25);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    book.ExecuteTrade(sell3);
@@ -727,7 +782,7 @@ TEST(OrderbookTest, OrderExactlyMatchesAvailableLiquidity) {
 // Test: Single unit volume order executes correctly
 TEST(OrderbookTest, SingleUnitVolumeOrderExecutes) {
    Orderbook book;
-   Order sell(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 1);
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 1);
    book.ExecuteTrade(sell);
    
    Order buy(OrderType::Market, 2, 0, Side::Buy, 1);
@@ -739,12 +794,12 @@ TEST(OrderbookTest, SingleUnitVolumeOrderExecutes) {
 // Test: Limit order crosses spread and takes best price
 TEST(OrderbookTest, LimitOrderCrossesSpreadTakesBestPrice) {
    Orderbook book;
-   Order sell1(OrderType::GoodTillCancel, 1, 100.0, Side::Sell, 30);
-   Order sell2(OrderType::GoodTillCancel, 2, 101.0, Side::Sell, 40);
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
    book.ExecuteTrade(sell1);
    book.ExecuteTrade(sell2);
    
-   Order buy(OrderType::GoodTillCancel, 3, 105.0, Side::Buy, 50);
+   Order buy(OrderType::GoodTillCancel, 3, 105, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(buy);
    
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
@@ -753,12 +808,12 @@ TEST(OrderbookTest, LimitOrderCrossesSpreadTakesBestPrice) {
 // Test: Back-to-back modifications on same order
 TEST(OrderbookTest, BackToBackModificationsOnSameOrder) {
    Orderbook book;
-   Order order(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 100);
+   Order order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 100);
    book.ExecuteTrade(order);
    
-   bool result1 = book.ModifyOrder(1, 100.0, 80);
-   bool result2 = book.ModifyOrder(1, 95.0, 60);
-   bool result3 = book.ModifyOrder(1, 95.0, 40);
+   bool result1 = book.ModifyOrder(1, 100, 80);
+   bool result2 = book.ModifyOrder(1, 95, 60);
+   bool result3 = book.ModifyOrder(1, 95, 40);
    
    EXPECT_TRUE(result1);
    EXPECT_TRUE(result2);
@@ -768,12 +823,12 @@ TEST(OrderbookTest, BackToBackModificationsOnSameOrder) {
 // Test: Cancel then re-add order with same ID behavior
 TEST(OrderbookTest, CancelThenReAddOrderWithSameID) {
    Orderbook book;
-   Order order1(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order1(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    book.ExecuteTrade(order1);
    
    book.CancelOrder(1);
    
-   Order order2(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
+   Order order2(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
    OrderOutcome result = book.ExecuteTrade(order2);
    
    EXPECT_EQ(result, OrderOutcome::AddedToOrderbook);
@@ -782,12 +837,12 @@ TEST(OrderbookTest, CancelThenReAddOrderWithSameID) {
 // Test: Modify order at different price level moves it correctly
 TEST(OrderbookTest, ModifyOrderMovesToDifferentPriceLevel) {
    Orderbook book;
-   Order buy1(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 50);
-   Order buy2(OrderType::GoodTillCancel, 2, 95.0, Side::Buy, 30);
+   Order buy1(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
+   Order buy2(OrderType::GoodTillCancel, 2, 95, Side::Buy, 30);
    book.ExecuteTrade(buy1);
    book.ExecuteTrade(buy2);
    
-   bool result = book.ModifyOrder(1, 98.0, 50);
+   bool result = book.ModifyOrder(1, 98, 50);
    
    EXPECT_TRUE(result);
 }
@@ -795,10 +850,10 @@ TEST(OrderbookTest, ModifyOrderMovesToDifferentPriceLevel) {
 // Test: Sell side limit order partially fills and adds remainder
 TEST(OrderbookTest, SellLimitOrderPartiallyFillsAndAddsRemainder) {
    Orderbook book;
-   Order buy(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 30);
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 30);
    book.ExecuteTrade(buy);
    
-   Order sell(OrderType::GoodTillCancel, 2, 100.0, Side::Sell, 80);
+   Order sell(OrderType::GoodTillCancel, 2, 100, Side::Sell, 80);
    OrderOutcome result = book.ExecuteTrade(sell);
    
    EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndAddedToBook);
@@ -807,9 +862,9 @@ TEST(OrderbookTest, SellLimitOrderPartiallyFillsAndAddsRemainder) {
 // Test: Market sell order consumes multiple bid levels
 TEST(OrderbookTest, MarketSellOrderConsumesMultipleBidLevels) {
    Orderbook book;
-   Order buy1(OrderType::GoodTillCancel, 1, 100.0, Side::Buy, 30);
-   Order buy2(OrderType::GoodTillCancel, 2, 99.0, Side::Buy, 40);
-   Order buy3(OrderType::GoodTillCancel, 3, 98.0, Side::Buy, 20);
+   Order buy1(OrderType::GoodTillCancel, 1, 100, Side::Buy, 30);
+   Order buy2(OrderType::GoodTillCancel, 2, 99, Side::Buy, 40);
+   Order buy3(OrderType::GoodTillCancel, 3, 98, Side::Buy, 20);
    book.ExecuteTrade(buy1);
    book.ExecuteTrade(buy2);
    book.ExecuteTrade(buy3);
@@ -820,6 +875,1915 @@ TEST(OrderbookTest, MarketSellOrderConsumesMultipleBidLevels) {
    EXPECT_EQ(result, OrderOutcome::FullyFilled);
 }
 
+// Test: Cancelling an order in the middle of a level keeps FIFO for the rest
+TEST(OrderbookTest, CancelMiddleOrderKeepsRemainingQueue) {
+   Orderbook book;
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 100, Side::Sell, 20);
+   Order sell3(OrderType::GoodTillCancel, 3, 100, Side::Sell, 10);
+   book.ExecuteTrade(sell1);
+   book.ExecuteTrade(sell2);
+   book.ExecuteTrade(sell3);
+
+   EXPECT_TRUE(book.CancelOrder(2));
+   EXPECT_FALSE(book.CancelOrder(2));
+
+   Order buy(OrderType::Market, 4, 0, Side::Buy, 50);
+   OrderOutcome result = book.ExecuteTrade(buy);
+
+   EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndCancelled);
+   EXPECT_FALSE(book.CancelOrder(1));
+   EXPECT_FALSE(book.CancelOrder(3));
+}
+
+// Test: Cancelling the last order at a level removes the level
+TEST(OrderbookTest, CancelLastOrderRemovesLevel) {
+   Orderbook book;
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
+   book.ExecuteTrade(sell);
+
+   book.CancelOrder(1);
+
+   Order buy(OrderType::Market, 2, 0, Side::Buy, 50);
+   OrderOutcome result = book.ExecuteTrade(buy);
+
+   EXPECT_EQ(result, OrderOutcome::Cancelled);
+}
+
+// Test: Modified order can still be cancelled at its new price
+TEST(OrderbookTest, CancelAfterModifyToNewPrice) {
+   Orderbook book;
+   Order buy1(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
+   Order buy2(OrderType::GoodTillCancel, 2, 98, Side::Buy, 30);
+   book.ExecuteTrade(buy1);
+   book.ExecuteTrade(buy2);
+
+   book.ModifyOrder(1, 98, 40);
+   EXPECT_TRUE(book.CancelOrder(2));
+
+   Order sell(OrderType::ImmediateOrCancel, 3, 98, Side::Sell, 40);
+   OrderOutcome result = book.ExecuteTrade(sell);
+
+   EXPECT_EQ(result, OrderOutcome::FullyFilled);
+   EXPECT_FALSE(book.CancelOrder(1));
+}
+
+// Test: Decimal prices convert to and from integer ticks at the book's tick size
+TEST(OrderbookTest, TickSizeConvertsDecimalPrices) {
+   Orderbook book(0.01);
+
+   EXPECT_EQ(book.ToTicks(100.25), 10025);
+   EXPECT_EQ(book.ToTicks(0.07), 7);
+   EXPECT_DOUBLE_EQ(book.ToDecimalPrice(10025), 100.25);
+}
+
+// Test: Fills at tick prices leave exact integer remainders
+TEST(OrderbookTest, TickPricedOrdersFillExactly) {
+   Orderbook book(0.01);
+   Order sell1(OrderType::GoodTillCancel, 1, book.ToTicks(100.01), Side::Sell, 3);
+   Order sell2(OrderType::GoodTillCancel, 2, book.ToTicks(100.02), Side::Sell, 7);
+   book.ExecuteTrade(sell1);
+   book.ExecuteTrade(sell2);
+
+   Order buy(OrderType::FillOrKill, 3, book.ToTicks(100.02), Side::Buy, 10);
+   OrderOutcome result = book.ExecuteTrade(buy);
+
+   EXPECT_EQ(result, OrderOutcome::FullyFilled);
+   EXPECT_FALSE(book.CancelOrder(2));
+}
+
+// Test: Orders far outside the initial ladder window still match in price order
+TEST(OrderbookTest, LadderRecentresForDistantPrices) {
+   Orderbook book;
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 10);
+   Order sell2(OrderType::GoodTillCancel, 2, 1000000, Side::Sell, 10);
+   Order sell3(OrderType::GoodTillCancel, 3, 5, Side::Sell, 10);
+   book.ExecuteTrade(sell1);
+   book.ExecuteTrade(sell2);
+   book.ExecuteTrade(sell3);
+
+   Order buy(OrderType::ImmediateOrCancel, 4, 100, Side::Buy, 30);
+   OrderOutcome result = book.ExecuteTrade(buy);
+
+   EXPECT_EQ(result, OrderOutcome::PartiallyFilledAndCancelled);
+   EXPECT_FALSE(book.CancelOrder(1));
+   EXPECT_FALSE(book.CancelOrder(3));
+   EXPECT_TRUE(book.CancelOrder(2));
+}
+
+// Test: Ladder cursors track the best and worst occupied levels
+TEST(PriceLadderTest, CursorsFollowInsertAndErase) {
+   OrderSlab slab;
+   PriceLadder<Side::Buy> bids(8);
+   bids[100].Append(slab, slab.Allocate(Order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 10)));
+   bids[97].Append(slab, slab.Allocate(Order(OrderType::GoodTillCancel, 2, 97, Side::Buy, 10)));
+   bids[103].Append(slab, slab.Allocate(Order(OrderType::GoodTillCancel, 3, 103, Side::Buy, 10)));
+
+   EXPECT_EQ(bids.BestPrice(), 103);
+   EXPECT_EQ(bids.LevelCount(), 3u);
+
+   bids.Best().PopFront(slab);
+   bids.PopBest();
+   EXPECT_EQ(bids.BestPrice(), 100);
+
+   bids.Find(97)->PopFront(slab);
+   bids.Erase(97);
+   EXPECT_EQ(bids.Find(97), nullptr);
+   EXPECT_EQ(bids.BestPrice(), 100);
+
+   bids.Best().PopFront(slab);
+   bids.PopBest();
+   EXPECT_TRUE(bids.empty());
+}
+
+// Test: A small window keeps its levels consistent with an ordered map
+// while the touch wanders far outside it and back
+TEST(PriceLadderTest, WindowAndOverflowMatchOrderedMap) {
+   OrderSlab slab;
+   PriceLadder<Side::Sell> asks(8);
+   std::map<Price, Volume> expected;
+   std::mt19937_64 random(11);
+
+   auto removeFront = [&](const Price price) {
+      PriceLevel& level = *asks.Find(price);
+      const SlotIndex slot = level.PopFront(slab);
+      expected[price] -= slab[slot].remaining;
+      slab.Release(slot);
+      if (level.empty())
+      {
+         asks.Erase(price);
+         expected.erase(price);
+      }
+   };
+
+   for (ID step = 0; step < 20000; ++step)
+   {
+      const std::uint64_t action = random() % 10;
+      if (action < 5 || expected.empty())
+      {
+         const Price price = static_cast<Price>(random() % 40) * 3 - 20;
+         const Volume volume = static_cast<Volume>(random() % 9) + 1;
+         asks[price].Append(slab, slab.Allocate(Order(OrderType::GoodTillCancel, step, price, Side::Sell, volume)));
+         expected[price] += volume;
+      }
+      else if (action < 7)
+      {
+         removeFront(asks.BestPrice());
+      }
+      else if (action < 9)
+      {
+         auto it = expected.begin();
+         std::advance(it, static_cast<std::ptrdiff_t>(random() % expected.size()));
+         removeFront(it->first);
+      }
+      else
+      {
+         const Price low = static_cast<Price>(random() % 120) - 20;
+         const Price high = low + static_cast<Price>(random() % 30);
+         asks.EraseRange(low, high, [&](const Price price, PriceLevel& level) {
+            level.ForEach(slab, [&](const SlotIndex slot) { slab.Release(slot); return true; });
+            level.Clear();
+            expected.erase(price);
+         });
+      }
+
+      ASSERT_EQ(asks.LevelCount(), expected.size());
+      if (!expected.empty())
+      {
+         ASSERT_EQ(asks.BestPrice(), expected.begin()->first);
+      }
+   }
+
+   std::vector<std::pair<Price, Volume>> levels;
+   asks.ForEachLevel([&](const Price price, const PriceLevel& level) {
+      levels.emplace_back(price, level.GetTotalVolume());
+      return true;
+   });
+   const std::vector<std::pair<Price, Volume>> ordered(expected.begin(), expected.end());
+   EXPECT_EQ(levels, ordered);
+}
+
+// Test: Prices far apart and at the ends of the Price range rest and match
+// without the ladder spanning the gap between them
+TEST(OrderbookTest, FarApartPricesDoNotWidenTheLadder) {
+   Orderbook book;
+   const Price highest = std::numeric_limits<Price>::max();
+   const Price lowest = std::numeric_limits<Price>::min();
+
+   Order far(OrderType::GoodTillCancel, 1, 1, Side::Buy, 10);
+   book.ExecuteTrade(far);
+   const std::size_t allocations = book.GetHeapAllocationCount();
+
+   Order touch(OrderType::GoodTillCancel, 2, 10000000, Side::Buy, 20);
+   Order bottom(OrderType::GoodTillCancel, 3, lowest, Side::Buy, 7);
+   Order top(OrderType::GoodTillCancel, 4, highest, Side::Sell, 5);
+   book.ExecuteTrade(touch);
+   book.ExecuteTrade(bottom);
+   book.ExecuteTrade(top);
+   EXPECT_EQ(book.GetHeapAllocationCount(), allocations);
+
+   const std::vector<DepthLevel> bids = book.GetDepth(Side::Buy, 10);
+   ASSERT_EQ(bids.size(), 3u);
+   EXPECT_EQ(bids[0].price, 10000000);
+   EXPECT_EQ(bids[1].price, 1);
+   EXPECT_EQ(bids[2].price, lowest);
+
+   Order sell(OrderType::ImmediateOrCancel, 5, 1, Side::Sell, 25);
+   EXPECT_EQ(book.ExecuteTrade(sell), OrderOutcome::FullyFilled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 1), 5);
+
+   Order sweep(OrderType::Market, 6, 0, Side::Sell, 12);
+   EXPECT_EQ(book.ExecuteTrade(sweep), OrderOutcome::FullyFilled);
+   EXPECT_TRUE(book.GetDepth(Side::Buy, 10).empty());
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, highest), 5);
+}
+
+// Test: The slab hands freed slots out again and keeps every order field
+TEST(OrderSlabTest, ReusesFreedSlotsAndRoundTripsOrders) {
+   OrderSlab slab;
+   Order order(OrderType::GoodTillDate, 42, 101, Side::Sell, 10);
+   order.SetRemainingVolume(7);
+   order.SetOwner(5);
+   order.SetSelfTradePrevention(SelfTradePrevention::Decrement);
+   order.SetExpiry(900);
+
+   const SlotIndex first = slab.Allocate(Order(OrderType::GoodTillCancel, 1, 100, Side::Buy, 10));
+   const SlotIndex second = slab.Allocate(order);
+   EXPECT_EQ(first, 0u);
+   EXPECT_EQ(second, 1u);
+   EXPECT_EQ(slab[second].remaining, 7);
+
+   const Order copy = slab.ToOrder(second);
+   EXPECT_EQ(copy.GetId(), 42u);
+   EXPECT_EQ(copy.GetType(), OrderType::GoodTillDate);
+   EXPECT_EQ(copy.GetPrice(), 101);
+   EXPECT_EQ(copy.GetSide(), Side::Sell);
+   EXPECT_EQ(copy.GetInitialVolume(), 10);
+   EXPECT_EQ(copy.GetRemainingVolume(), 7);
+   EXPECT_EQ(copy.GetOwner(), 5u);
+   EXPECT_EQ(copy.GetSelfTradePrevention(), SelfTradePrevention::Decrement);
+   EXPECT_EQ(copy.GetExpiry(), 900u);
+
+   slab.Release(first);
+   EXPECT_EQ(slab.size(), 1u);
+   EXPECT_EQ(slab.Allocate(Order(OrderType::GoodTillCancel, 3, 99, Side::Buy, 5)), first);
+   EXPECT_EQ(slab.Allocate(Order(OrderType::GoodTillCancel, 4, 99, Side::Buy, 5)), 2u);
+}
+
+// Test: The order index agrees with a map through random churn and growth
+TEST(OrderIndexTest, MatchesMapUnderRandomChurn) {
+   OrderIndex index(16);
+   std::unordered_map<ID, SlotIndex> expected;
+   std::mt19937_64 random(7);
+
+   for (SlotIndex step = 0; step < 20000; ++step)
+   {
+      // A narrow key range so erases and overwrites hit live entries.
+      const ID id = random() % 3000 * 0x10001;
+      if (random() % 3 == 0)
+      {
+         OrderIndex::Entry* entry = index.Find(id);
+         ASSERT_EQ(entry != nullptr, expected.count(id) == 1);
+         if (entry)
+         {
+            index.Erase(entry);
+            expected.erase(id);
+         }
+      }
+      else
+      {
+         // A live id keeps its slot.
+         ASSERT_EQ(index.Insert(id, step), expected.count(id) == 0);
+         expected.emplace(id, step);
+      }
+   }
+
+   ASSERT_EQ(index.size(), expected.size());
+   for (const auto& [id, slot] : expected)
+   {
+      const OrderIndex::Entry* entry = index.Find(id);
+      ASSERT_NE(entry, nullptr);
+      EXPECT_EQ(entry->slot, slot);
+   }
+   EXPECT_EQ(index.Find(1), nullptr);
+}
+
+// Test: An order reusing a live ID is rejected, so the first order can
+// still fill and leave the book cleanly
+TEST(OrderbookTest, DuplicateLiveIdIsRejected) {
+   Orderbook book;
+   Order first(OrderType::GoodTillCancel, 1, 100, Side::Buy, 10);
+   Order again(OrderType::GoodTillCancel, 1, 101, Side::Buy, 5);
+   Order stop(OrderType::Stop, 2, 0, Side::Sell, 5, 90);
+   Order stopAgain(OrderType::GoodTillCancel, 2, 99, Side::Buy, 5);
+   EXPECT_EQ(book.ExecuteTrade(first), OrderOutcome::AddedToOrderbook);
+   EXPECT_EQ(book.ExecuteTrade(again), OrderOutcome::Cancelled);
+   EXPECT_EQ(book.ExecuteTrade(stop), OrderOutcome::AddedToOrderbook);
+   EXPECT_EQ(book.ExecuteTrade(stopAgain), OrderOutcome::Cancelled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 101), 0);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 99), 0);
+
+   // The live orders are untouched and nothing reports them as gone.
+   EXPECT_EQ(book.FindOrder(1)->GetRemainingVolume(), 10);
+   EXPECT_EQ(book.GetPendingStopCount(), 1u);
+   EXPECT_FALSE(book.GetCompletedOrders().Contains(1));
+   EXPECT_FALSE(book.GetCompletedOrders().Contains(2));
+   std::size_t rejected = 0;
+   for (std::size_t i = 0; i < book.GetExecutionEvents().size(); ++i)
+   {
+      const ExecutionEvent& event = book.GetExecutionEvents()[i];
+      EXPECT_NE(event.type, ExecutionEventType::Cancelled);
+      rejected += event.type == ExecutionEventType::Rejected;
+   }
+   EXPECT_EQ(rejected, 2u);
+
+   Order sell(OrderType::GoodTillCancel, 3, 100, Side::Sell, 10);
+   EXPECT_EQ(book.ExecuteTrade(sell), OrderOutcome::FullyFilled);
+   EXPECT_FALSE(book.FindOrder(1).has_value());
+   EXPECT_TRUE(book.GetDepth(Side::Buy, 10).empty());
+
+   // Once the first order has left, its ID is free again.
+   Order reused(OrderType::GoodTillCancel, 1, 98, Side::Buy, 4);
+   EXPECT_EQ(book.ExecuteTrade(reused), OrderOutcome::AddedToOrderbook);
+   EXPECT_EQ(book.GetPendingStopCount(), 1u);
+}
+
+// Test: Level aggregates follow inserts, fills, modifies and cancels
+TEST(OrderbookTest, LevelAggregatesTrackRestingVolume) {
+   Orderbook book;
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 100, Side::Sell, 20);
+   Order sell3(OrderType::GoodTillCancel, 3, 101, Side::Sell, 10);
+   book.ExecuteTrade(sell1);
+   book.ExecuteTrade(sell2);
+   book.ExecuteTrade(sell3);
+
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 100), 50);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 100), 2u);
+
+   Order buy(OrderType::Market, 4, 0, Side::Buy, 35);
+   book.ExecuteTrade(buy);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 100), 15);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 100), 1u);
+
+   book.ModifyOrder(2, 100, 5);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 100), 5);
+
+   book.ModifyOrder(2, 101, 5);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 100), 0);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 100), 0u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 15);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 101), 2u);
+
+   book.CancelOrder(3);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 5);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 101), 1u);
+}
+
+// Test: FOK check uses level totals after partial fills
+TEST(OrderbookTest, FOKUsesLevelTotalsAfterPartialFill) {
+   Orderbook book;
+   Order buy1(OrderType::GoodTillCancel, 1, 100, Side::Buy, 50);
+   Order buy2(OrderType::GoodTillCancel, 2, 99, Side::Buy, 50);
+   book.ExecuteTrade(buy1);
+   book.ExecuteTrade(buy2);
+
+   Order sell1(OrderType::Market, 3, 0, Side::Sell, 30);
+   book.ExecuteTrade(sell1);
+
+   Order sell2(OrderType::FillOrKill, 4, 99, Side::Sell, 71);
+   EXPECT_EQ(book.ExecuteTrade(sell2), OrderOutcome::Cancelled);
+
+   Order sell3(OrderType::FillOrKill, 5, 99, Side::Sell, 70);
+   EXPECT_EQ(book.ExecuteTrade(sell3), OrderOutcome::FullyFilled);
+}
+
+// Test: Steady-state matching reuses pooled storage once warmed up
+TEST(OrderbookTest, NoHeapAllocationAfterWarmUp) {
+   OrderbookCapacity capacity;
+   capacity.maxOrders = 1024;
+   capacity.completedOrders = 4096;
+   Orderbook book(1.0, capacity);
+
+   auto cycle = [&book](ID firstId) {
+      for (ID i = 0; i < 200; ++i)
+      {
+         Order sell(OrderType::GoodTillCancel, firstId + i, 100 + static_cast<Price>(i % 20), Side::Sell, 10);
+         book.ExecuteTrade(sell);
+      }
+      for (ID i = 0; i < 100; ++i)
+         book.CancelOrder(firstId + 2 * i);
+      for (ID i = 0; i < 50; ++i)
+         book.ModifyOrder(firstId + 2 * i + 1, 90 + static_cast<Price>(i % 5) + 30, 5);
+
+      Order sweep(OrderType::Market, firstId + 1000, 0, Side::Buy, 100000);
+      book.ExecuteTrade(sweep);
+   };
+
+   cycle(1);
+   const std::size_t warmedUp = book.GetHeapAllocationCount();
+
+   for (ID round = 1; round < 5; ++round)
+      cycle(round * 10000);
+
+   EXPECT_EQ(book.GetHeapAllocationCount(), warmedUp);
+}
+
+// Test: Filling a large book to near its order capacity from empty does
+// not touch the heap, expiring orders included
+TEST(OrderbookTest, NoHeapAllocationFillingToCapacity) {
+   OrderbookCapacity capacity;
+   capacity.maxOrders = 100000;
+   Orderbook book(1.0, capacity);
+   const std::size_t constructed = book.GetHeapAllocationCount();
+
+   for (ID id = 1; id <= 90000; ++id)
+   {
+      Order bid(id % 3 == 0 ? OrderType::GoodTillDate : OrderType::GoodTillCancel, id,
+                1000 - static_cast<Price>(id % 100), Side::Buy, 10);
+      bid.SetExpiry(1000 + id);
+      book.ExecuteTrade(bid);
+   }
+
+   EXPECT_EQ(book.GetHeapAllocationCount(), constructed);
+   EXPECT_EQ(book.AdvanceTime(1000 + 30000), 10000u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 1000), 8000);
+}
+
+// Test: A touch that keeps moving past the ladder's window does not go
+// back to the heap once warmed up
+TEST(OrderbookTest, NoHeapAllocationAsTouchLeavesWindow) {
+   OrderbookCapacity capacity;
+   capacity.priceLevels = 256;
+   Orderbook book(1.0, capacity);
+
+   Order far(OrderType::GoodTillCancel, 1, 20000000, Side::Sell, 10);
+   Order bid(OrderType::GoodTillCancel, 2, 1, Side::Buy, 10);
+   Order moving(OrderType::GoodTillCancel, 3, 10000000, Side::Sell, 10);
+   book.ExecuteTrade(far);
+   book.ExecuteTrade(bid);
+   book.ExecuteTrade(moving);
+
+   Price price = 10000000;
+   auto step = [&book, &price](int moves) {
+      for (int i = 0; i < moves; ++i)
+      {
+         price -= 50;
+         ASSERT_TRUE(book.ModifyOrder(3, price, 10));
+      }
+   };
+
+   step(100);
+   const std::size_t warmedUp = book.GetHeapAllocationCount();
+   step(20000);
+
+   EXPECT_EQ(book.GetHeapAllocationCount(), warmedUp);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, price), 10);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 20000000), 10);
+   EXPECT_EQ(book.GetDepth(Side::Sell, 10).size(), 2u);
+}
+
+// Test: Matching publishes accept, fill, partial fill and cancel reports in order
+TEST(OrderbookTest, ExecutionEventsReportFills) {
+   Orderbook book;
+   Order sell1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 30);
+   Order sell2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 40);
+   book.ExecuteTrade(sell1);
+   book.ExecuteTrade(sell2);
+   book.GetExecutionEvents().Clear();
+
+   Order buy(OrderType::ImmediateOrCancel, 3, 101, Side::Buy, 50);
+   book.ExecuteTrade(buy);
+
+   auto& events = book.GetExecutionEvents();
+   ASSERT_EQ(events.size(), 3u);
+
+   EXPECT_EQ(events[0].type, ExecutionEventType::Accepted);
+   EXPECT_EQ(events[0].orderId, 3u);
+
+   EXPECT_EQ(events[1].type, ExecutionEventType::Fill);
+   EXPECT_EQ(events[1].orderId, 1u);
+   EXPECT_EQ(events[1].counterpartyId, 3u);
+   EXPECT_EQ(events[1].price, 100);
+   EXPECT_EQ(events[1].quantity, 30);
+   EXPECT_EQ(events[1].remaining, 0);
+
+   EXPECT_EQ(events[2].type, ExecutionEventType::PartialFill);
+   EXPECT_EQ(events[2].orderId, 2u);
+   EXPECT_EQ(events[2].price, 101);
+   EXPECT_EQ(events[2].quantity, 20);
+   EXPECT_EQ(events[2].remaining, 20);
+}
+
+// Test: Cancel, modify and rejection each publish one report
+TEST(OrderbookTest, ExecutionEventsReportCancelAndModify) {
+   Orderbook book;
+   Order buy(OrderType::GoodTillCancel, 1, 100, Side::Buy, 30);
+   book.ExecuteTrade(buy);
+   book.ModifyOrder(1, 99, 20);
+   book.CancelOrder(1);
+
+   Order market(OrderType::Market, 2, 0, Side::Sell, 10);
+   book.ExecuteTrade(market);
+
+   std::vector<ExecutionEvent> drained;
+   book.GetExecutionEvents().Drain([&drained](const ExecutionEvent& event) { drained.push_back(event); });
+
+   ASSERT_EQ(drained.size(), 4u);
+   EXPECT_EQ(drained[1].type, ExecutionEventType::Modified);
+   EXPECT_EQ(drained[1].price, 99);
+   EXPECT_EQ(drained[1].quantity, 20);
+   EXPECT_EQ(drained[2].type, ExecutionEventType::Cancelled);
+   EXPECT_EQ(drained[2].quantity, 20);
+   EXPECT_EQ(drained[3].type, ExecutionEventType::Cancelled);
+   EXPECT_EQ(drained[3].orderId, 2u);
+   EXPECT_TRUE(book.GetExecutionEvents().empty());
+}
+
+// Test: A full event ring overwrites the oldest report and counts the overrun
+TEST(RingBufferTest, OverwritesOldestWhenFull) {
+   RingBuffer<int> ring(4);
+   for (int i = 0; i < 6; ++i)
+      ring.Push(i);
+
+   EXPECT_EQ(ring.size(), 4u);
+   EXPECT_EQ(ring.GetOverrunCount(), 2u);
+
+   int value = 0;
+   ASSERT_TRUE(ring.Pop(value));
+   EXPECT_EQ(value, 2);
+}
+
+// Test: Completed orders are looked up by ID within the retained window
+TEST(OrderbookTest, CompletedOrdersIndexedById) {
+   Orderbook book;
+   Order sell(OrderType::GoodTillCancel, 1, 100, Side::Sell, 50);
+   book.ExecuteTrade(sell);
+
+   Order buy(OrderType::Market, 2, 0, Side::Buy, 50);
+   book.ExecuteTrade(buy);
+
+   const CompletedOrders& completed = book.GetCompletedOrders();
+   ASSERT_TRUE(completed.Contains(1));
+   ASSERT_TRUE(completed.Contains(2));
+   EXPECT_FALSE(completed.Contains(3));
+   EXPECT_EQ(completed.Find(1)->GetRemainingVolume(), 0);
+}
+
+// Test: A full completed-order window spills its oldest entries to the segment
+TEST(CompletedOrdersTest, EvictsOldestToSegment) {
+   const std::string path = ::testing::TempDir() + "completed_orders_segment.bin";
+   std::remove(path.c_str());
+
+   {
+      CompletedOrders completed(2);
+      ASSERT_TRUE(completed.OpenSegment(path));
+
+      for (ID id = 1; id <= 5; ++id)
+         completed.Add(Order(OrderType::GoodTillCancel, id, 100 + static_cast<Price>(id), Side::Buy, 10));
+
+      EXPECT_EQ(completed.size(), 2u);
+      EXPECT_EQ(completed.GetSpilledCount(), 3u);
+      EXPECT_FALSE(completed.Contains(3));
+      EXPECT_TRUE(completed.Contains(4));
+      EXPECT_TRUE(completed.Contains(5));
+   }
+
+   const std::vector<Order> spilled = CompletedOrders::ReadSegment(path);
+   ASSERT_EQ(spilled.size(), 3u);
+   EXPECT_EQ(spilled[0].GetId(), 1u);
+   EXPECT_EQ(spilled[2].GetId(), 3u);
+   EXPECT_EQ(spilled[2].GetPrice(), 103);
+   EXPECT_EQ(spilled[2].GetSide(), Side::Buy);
+   std::remove(path.c_str());
+}
+
+// Test: Order ID generation is independent per book
+TEST(OrderbookTest, OrderIdsArePerBook) {
+   Orderbook first;
+   Orderbook second;
+
+   EXPECT_EQ(first.GetNextOrderId(), 1u);
+   EXPECT_EQ(first.GetNextOrderId(), 2u);
+   EXPECT_EQ(second.GetNextOrderId(), 1u);
+}
+
+// Test: Commands from several gateway threads are all applied and answered
+TEST(MatchingEngineTest, AppliesCommandsFromMultipleProducers) {
+   constexpr std::size_t producers = 3;
+   constexpr ID ordersPerProducer = 2000;
+   MatchingEngine engine(producers, 256);
+   engine.Start();
+
+   std::vector<std::thread> gateways;
+   std::vector<std::size_t> accepted(producers, 0);
+   std::vector<std::size_t> cancelled(producers, 0);
+
+   for (std::size_t p = 0; p < producers; ++p)
+   {
+      gateways.emplace_back([&, p] {
+         const ID base = (p + 1) * 1000000;
+         std::size_t expected = 0;
+         std::size_t received = 0;
+         EngineResponse response;
+
+         auto submit = [&](const EngineCommand& command) {
+            while (!engine.Submit(p, command))
+            {
+               while (engine.PollResponse(p, response))
+               {
+                  ++received;
+                  accepted[p] += response.type == CommandType::New && response.success;
+                  cancelled[p] += response.type == CommandType::Cancel && response.success;
+               }
+            }
+            ++expected;
+         };
+
+         for (ID i = 0; i < ordersPerProducer; ++i)
+         {
+            const Side side = (p % 2 == 0) ? Side::Buy : Side::Sell;
+            const Price price = (side == Side::Buy) ? 90 - static_cast<Price>(i % 10) : 110 + static_cast<Price>(i % 10);
+            submit({CommandType::New, OrderType::GoodTillCancel, side, base + i, price, 10});
+            if (i % 2 == 0)
+               submit({CommandType::Cancel, OrderType::GoodTillCancel, side, base + i, 0, 0});
+         }
+
+         while (received < expected)
+         {
+            if (engine.PollResponse(p, response))
+            {
+               ++received;
+               accepted[p] += response.type == CommandType::New && response.success;
+               cancelled[p] += response.type == CommandType::Cancel && response.success;
+            }
+         }
+      });
+   }
+
+   for (auto& gateway : gateways)
+      gateway.join();
+   engine.Stop();
+
+   for (std::size_t p = 0; p < producers; ++p)
+   {
+      EXPECT_EQ(accepted[p], ordersPerProducer);
+      EXPECT_EQ(cancelled[p], ordersPerProducer / 2);
+   }
+   EXPECT_FALSE(engine.GetBook().CancelOrder(1000000));
+   EXPECT_TRUE(engine.GetBook().CancelOrder(1000001));
+}
+
+// Test: Symbols are routed to their own books and IDs are per book
+TEST(MultiInstrumentEngineTest, RoutesBySymbol) {
+   MultiInstrumentEngine engine(2, 1, 64);
+   const SymbolID first = engine.AddInstrument("AAA", 1.0, {}, 0);
+   const SymbolID second = engine.AddInstrument("BBB", 1.0, {}, 1);
+
+   SymbolID found = 0;
+   ASSERT_TRUE(engine.FindInstrument("BBB", found));
+   EXPECT_EQ(found, second);
+   EXPECT_FALSE(engine.FindInstrument("CCC", found));
+
+   engine.Start();
+   engine.Submit(0, first, {CommandType::New, OrderType::GoodTillCancel, Side::Sell, 1, 100, 10});
+   engine.Submit(0, second, {CommandType::New, OrderType::GoodTillCancel, Side::Buy, 1, 100, 10});
+
+   InstrumentResponse response;
+   std::size_t received = 0;
+   while (received < 2)
+   {
+      if (engine.PollResponse(0, response))
+      {
+         EXPECT_EQ(response.response.outcome, OrderOutcome::AddedToOrderbook);
+         ++received;
+      }
+   }
+   engine.Stop();
+
+   EXPECT_EQ(engine.GetBook(first).GetVolumeAtPrice(Side::Sell, 100), 10);
+   EXPECT_EQ(engine.GetBook(second).GetVolumeAtPrice(Side::Buy, 100), 10);
+}
+
+// Test: Moving symbols between workers under load keeps each producer's order
+TEST(MultiInstrumentEngineTest, MoveInstrumentPreservesCommandOrder) {
+   constexpr std::size_t producers = 2;
+   constexpr std::size_t symbols = 4;
+   constexpr ID ordersPerSymbol = 1500;
+   MultiInstrumentEngine engine(3, producers, 128);
+
+   for (std::size_t s = 0; s < symbols; ++s)
+      engine.AddInstrument("SYM" + std::to_string(s));
+
+   engine.Start();
+   std::atomic<bool> done{false};
+   std::vector<std::size_t> failures(producers, 0);
+   std::vector<std::thread> gateways;
+
+   for (std::size_t p = 0; p < producers; ++p)
+   {
+      gateways.emplace_back([&, p] {
+         std::size_t expected = 0;
+         std::size_t received = 0;
+         InstrumentResponse response;
+
+         auto drain = [&] {
+            while (engine.PollResponse(p, response))
+            {
+               ++received;
+               failures[p] += !response.response.success;
+            }
+         };
+
+         for (ID i = 0; i < ordersPerSymbol; ++i)
+         {
+            for (SymbolID s = 0; s < symbols; ++s)
+            {
+               const ID id = (p + 1) * 1000000 + i;
+               const Side side = (p == 0) ? Side::Buy : Side::Sell;
+               const Price price = (p == 0) ? 90 : 110;
+               const EngineCommand add{CommandType::New, OrderType::GoodTillCancel, side, id, price, 5};
+               const EngineCommand cancel{CommandType::Cancel, OrderType::GoodTillCancel, side, id, 0, 0};
+
+               while (!engine.Submit(p, s, add))
+                  drain();
+               while (!engine.Submit(p, s, cancel))
+                  drain();
+               expected += 2;
+            }
+         }
+         while (received < expected)
+            drain();
+      });
+   }
+
+   std::thread mover([&] {
+      std::size_t round = 0;
+      while (!done.load())
+      {
+         engine.MoveInstrument(static_cast<SymbolID>(round % symbols), round % engine.GetWorkerCount());
+         ++round;
+         std::this_thread::yield();
+      }
+   });
+
+   for (auto& gateway : gateways)
+      gateway.join();
+   done.store(true);
+   mover.join();
+   engine.Stop();
+
+   for (std::size_t p = 0; p < producers; ++p)
+      EXPECT_EQ(failures[p], 0u);
+   for (SymbolID s = 0; s < symbols; ++s)
+      EXPECT_EQ(engine.GetBook(s).GetVolumeAtPrice(Side::Buy, 90), 0);
+}
+
+// Test: GetDepth returns aggregated levels from the touch outwards
+TEST(OrderbookTest, DepthReturnsTopLevels) {
+   Orderbook book;
+   for (Price price = 95; price <= 99; ++price)
+   {
+      Order bid(OrderType::GoodTillCancel, book.GetNextOrderId(), price, Side::Buy, 10);
+      book.ExecuteTrade(bid);
+   }
+   Order extra(OrderType::GoodTillCancel, book.GetNextOrderId(), 99, Side::Buy, 5);
+   book.ExecuteTrade(extra);
+
+   const std::vector<DepthLevel> depth = book.GetDepth(Side::Buy, 3);
+   ASSERT_EQ(depth.size(), 3u);
+   EXPECT_EQ(depth[0].price, 99);
+   EXPECT_EQ(depth[0].volume, 15);
+   EXPECT_EQ(depth[0].orderCount, 2u);
+   EXPECT_EQ(depth[2].price, 97);
+
+   EXPECT_EQ(book.GetDepth(Side::Buy, 100).size(), 5u);
+   EXPECT_TRUE(book.GetDepth(Side::Sell, 5).empty());
+}
+
+// Test: Applying the level updates rebuilds the same depth as GetDepth
+TEST(OrderbookTest, LevelUpdatesReproduceDepth) {
+   Orderbook book;
+   std::map<Price, DepthLevel> bidView;
+   std::map<Price, DepthLevel> askView;
+
+   auto apply = [&]()
+   {
+      LevelUpdate update;
+      while (book.GetLevelUpdates().Pop(update))
+      {
+         auto& view = (update.side == Side::Buy) ? bidView : askView;
+         if (update.orderCount == 0)
+            view.erase(update.price);
+         else
+            view[update.price] = {update.price, update.volume, update.orderCount};
+      }
+   };
+
+   for (ID i = 0; i < 200; ++i)
+   {
+      const ID id = book.GetNextOrderId();
+      const Side side = (i % 2) ? Side::Buy : Side::Sell;
+      const Price price = 100 + static_cast<Price>((i * 7) % 11) - 5;
+      const OrderType type = (i % 9 == 0) ? OrderType::ImmediateOrCancel : OrderType::GoodTillCancel;
+      Order order(type, id, price, side, 1 + static_cast<Volume>(i % 13));
+      book.ExecuteTrade(order);
+
+      if (i % 5 == 0)
+         book.CancelOrder(id - 3);
+      if (i % 7 == 0)
+         book.ModifyOrder(id - 2, price + ((side == Side::Buy) ? -1 : 1), 1);
+      apply();
+   }
+
+   const std::vector<DepthLevel> bids = book.GetDepth(Side::Buy, 1000);
+   ASSERT_EQ(bids.size(), bidView.size());
+   for (const DepthLevel& level : bids)
+   {
+      EXPECT_EQ(bidView[level.price].volume, level.volume);
+      EXPECT_EQ(bidView[level.price].orderCount, level.orderCount);
+   }
+
+   const std::vector<DepthLevel> asks = book.GetDepth(Side::Sell, 1000);
+   ASSERT_EQ(asks.size(), askView.size());
+   for (const DepthLevel& level : asks)
+   {
+      EXPECT_EQ(askView[level.price].volume, level.volume);
+      EXPECT_EQ(askView[level.price].orderCount, level.orderCount);
+   }
+   EXPECT_NE(book.GetLastTradePrice(), 0);
+}
+
+// Test: Last trade price follows the maker price of the most recent fill
+TEST(OrderbookTest, LastTradePrice) {
+   Orderbook book;
+   EXPECT_EQ(book.GetLastTradePrice(), 0);
+
+   Order ask1(OrderType::GoodTillCancel, 1, 101, Side::Sell, 5);
+   Order ask2(OrderType::GoodTillCancel, 2, 103, Side::Sell, 5);
+   book.ExecuteTrade(ask1);
+   book.ExecuteTrade(ask2);
+
+   Order buy(OrderType::GoodTillCancel, 3, 105, Side::Buy, 8);
+   book.ExecuteTrade(buy);
+   EXPECT_EQ(book.GetLastTradePrice(), 103);
+}
+
+// Test: Each kind of book change produces the matching L3 message
+TEST(L3FeedTest, EncodesEachMessageType) {
+   std::vector<char> buffer(64 * sizeof(L3Message));
+   L3Encoder encoder(buffer.data(), buffer.size());
+   Orderbook book;
+   book.AttachL3Encoder(&encoder);
+
+   Order ask(OrderType::GoodTillCancel, 1, 101, Side::Sell, 10);
+   book.ExecuteTrade(ask);
+   Order buy(OrderType::ImmediateOrCancel, 2, 101, Side::Buy, 4);
+   book.ExecuteTrade(buy);
+   book.ModifyOrder(1, 101, 5);
+   book.ModifyOrder(1, 102, 5);
+   book.CancelOrder(1);
+
+   ASSERT_EQ(encoder.GetBytesWritten(), 5 * sizeof(L3Message));
+   const L3Message* messages = reinterpret_cast<const L3Message*>(encoder.GetData());
+
+   EXPECT_EQ(messages[0].type, static_cast<std::uint8_t>(L3MessageType::Add));
+   EXPECT_EQ(messages[0].quantity, 10);
+   EXPECT_EQ(messages[1].type, static_cast<std::uint8_t>(L3MessageType::Execute));
+   EXPECT_EQ(messages[1].quantity, 4);
+   EXPECT_EQ(messages[2].type, static_cast<std::uint8_t>(L3MessageType::Cancel));
+   EXPECT_EQ(messages[2].quantity, 1);
+   EXPECT_EQ(messages[3].type, static_cast<std::uint8_t>(L3MessageType::Replace));
+   EXPECT_EQ(messages[3].price, 102);
+   EXPECT_EQ(messages[4].type, static_cast<std::uint8_t>(L3MessageType::Delete));
+
+   for (std::uint64_t i = 0; i < 5; ++i)
+   {
+      EXPECT_EQ(messages[i].sequence, i + 1);
+      EXPECT_EQ(messages[i].orderId, 1u);
+   }
+}
+
+// Test: A shadow book decoded from the feed matches the source book
+TEST(L3FeedTest, ShadowBookMatchesSource) {
+   std::vector<char> buffer(4096 * sizeof(L3Message));
+   L3Encoder encoder(buffer.data(), buffer.size());
+   L3ShadowBook shadow;
+   Orderbook book;
+   book.AttachL3Encoder(&encoder);
+
+   for (ID i = 0; i < 500; ++i)
+   {
+      const ID id = book.GetNextOrderId();
+      const Side side = (i % 3) ? Side::Buy : Side::Sell;
+      const Price price = 100 + static_cast<Price>((i * 5) % 9) - 4;
+      Order order(OrderType::GoodTillCancel, id, price, side, 1 + static_cast<Volume>(i % 17));
+      book.ExecuteTrade(order);
+
+      if (i % 4 == 0)
+         book.CancelOrder(id - 5);
+      if (i % 6 == 0)
+         book.ModifyOrder(id - 3, price, 2);
+      if (i % 10 == 0)
+      {
+         // Drain in batches, as a publisher would between sends.
+         const std::size_t messages = encoder.GetBytesWritten() / sizeof(L3Message);
+         EXPECT_EQ(shadow.Apply(encoder.GetData(), encoder.GetBytesWritten()), messages);
+         encoder.Rewind();
+      }
+   }
+   shadow.Apply(encoder.GetData(), encoder.GetBytesWritten());
+
+   EXPECT_EQ(shadow.GetLastSequence(), encoder.GetSequence());
+   for (Price price = 90; price <= 110; ++price)
+   {
+      EXPECT_EQ(shadow.GetVolumeAtPrice(Side::Buy, price), book.GetVolumeAtPrice(Side::Buy, price));
+      EXPECT_EQ(shadow.GetVolumeAtPrice(Side::Sell, price), book.GetVolumeAtPrice(Side::Sell, price));
+      EXPECT_EQ(shadow.GetOrderCountAtPrice(Side::Buy, price), book.GetOrderCountAtPrice(Side::Buy, price));
+      EXPECT_EQ(shadow.GetOrderCountAtPrice(Side::Sell, price), book.GetOrderCountAtPrice(Side::Sell, price));
+   }
+}
+
+// Test: Messages that do not fit are dropped and leave a sequence gap
+TEST(L3FeedTest, FullBufferLeavesSequenceGap) {
+   std::vector<char> buffer(2 * sizeof(L3Message));
+   L3Encoder encoder(buffer.data(), buffer.size());
+   Orderbook book;
+   book.AttachL3Encoder(&encoder);
+
+   for (ID id = 1; id <= 3; ++id)
+   {
+      Order order(OrderType::GoodTillCancel, id, 100, Side::Buy, 5);
+      book.ExecuteTrade(order);
+   }
+   EXPECT_EQ(encoder.GetDroppedCount(), 1u);
+
+   L3ShadowBook shadow;
+   EXPECT_EQ(shadow.Apply(encoder.GetData(), encoder.GetBytesWritten()), 2u);
+   encoder.Rewind();
+
+   book.CancelOrder(1);
+   EXPECT_EQ(shadow.Apply(encoder.GetData(), encoder.GetBytesWritten()), 0u);
+   EXPECT_EQ(shadow.GetLastSequence(), 2u);
+}
+
+// Test: LOBSTER CSV lines parse into messages; bad lines are skipped
+TEST(MessageReplayTest, ParsesLobsterCsv) {
+   const std::string csv =
+      "34200.004241176,1,16113575,18,5853300,1\r\n"
+      "\n"
+      "34200.1,3,16113575,18,5853300,-1\n"
+      "not,a,message\n"
+      "34201,4,42,7,5853400,-1";
+
+   LobsterCsvReader reader(csv.data(), csv.data() + csv.size());
+   ReplayMessage message;
+
+   ASSERT_TRUE(reader.Next(message));
+   EXPECT_EQ(message.timestamp, 34200004241176);
+   EXPECT_EQ(message.type, ReplayEventType::Submission);
+   EXPECT_EQ(message.orderId, 16113575u);
+   EXPECT_EQ(message.size, 18);
+   EXPECT_EQ(message.price, 5853300);
+   EXPECT_EQ(message.side, Side::Buy);
+
+   ASSERT_TRUE(reader.Next(message));
+   EXPECT_EQ(message.timestamp, 34200100000000);
+   EXPECT_EQ(message.type, ReplayEventType::Deletion);
+   EXPECT_EQ(message.side, Side::Sell);
+
+   ASSERT_TRUE(reader.Next(message));
+   EXPECT_EQ(message.type, ReplayEventType::VisibleExecution);
+   EXPECT_EQ(message.orderId, 42u);
+
+   EXPECT_FALSE(reader.Next(message));
+   EXPECT_EQ(reader.GetMalformedCount(), 1u);
+   EXPECT_EQ(reader.GetOffset(), csv.size());
+}
+
+// Test: Historical messages map onto submit, reduce, execute and cancel
+TEST(MessageReplayTest, AppliesMessagesToBook) {
+   Orderbook book;
+   MessageReplayer replayer(book);
+
+   const std::vector<ReplayMessage> messages = {
+      {1, 1, 100, 10, Side::Buy, ReplayEventType::Submission, {}},
+      {2, 2, 100, 5, Side::Buy, ReplayEventType::Submission, {}},
+      {3, 3, 102, 8, Side::Sell, ReplayEventType::Submission, {}},
+      {4, 1, 100, 3, Side::Buy, ReplayEventType::PartialCancel, {}},
+      {5, 1, 100, 4, Side::Buy, ReplayEventType::VisibleExecution, {}},
+      {6, 3, 102, 8, Side::Sell, ReplayEventType::Deletion, {}},
+      {7, 9, 100, 1, Side::Buy, ReplayEventType::HiddenExecution, {}},
+      {8, 77, 100, 1, Side::Buy, ReplayEventType::Deletion, {}},
+   };
+
+   // Written out and read back through the binary format.
+   const char* begin = reinterpret_cast<const char*>(messages.data());
+   BinaryMessageReader reader(begin, begin + messages.size() * sizeof(ReplayMessage));
+
+   std::vector<ReplayResult> results;
+   ReplayMessage message;
+   while (reader.Next(message))
+      results.push_back(replayer.Apply(message));
+
+   ASSERT_EQ(results.size(), messages.size());
+   EXPECT_EQ(results[6], ReplayResult::Skipped);
+   EXPECT_EQ(results[7], ReplayResult::UnknownOrder);
+
+   // Order 1: 10 - 3 cancelled - 4 executed = 3, still ahead of order 2.
+   ASSERT_TRUE(book.FindOrder(1).has_value());
+   EXPECT_EQ(book.FindOrder(1)->GetRemainingVolume(), 3);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 100), 8);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 102), 0);
+   EXPECT_FALSE(book.FindOrder(3).has_value());
+   EXPECT_EQ(book.GetLastTradePrice(), 100);
+}
+
+// Test: Histogram buckets stay within a few percent and percentiles are ordered
+TEST(LatencyHistogramTest, BucketsAndPercentiles) {
+   for (std::uint64_t value : {0ull, 63ull, 64ull, 1000ull, 123456ull, 1ull << 40})
+   {
+      const std::uint64_t bound = LatencyHistogram::UpperBoundOf(LatencyHistogram::IndexOf(value));
+      EXPECT_GE(bound, value);
+      EXPECT_LE(bound - value, value / 32 + 1);
+   }
+
+   LatencyHistogram histogram;
+   EXPECT_EQ(histogram.ValueAtPercentile(50.0), 0u);
+
+   for (std::uint64_t value = 1; value <= 10000; ++value)
+      histogram.Record(value);
+
+   EXPECT_EQ(histogram.GetCount(), 10000u);
+   EXPECT_EQ(histogram.GetMax(), 10000u);
+   EXPECT_NEAR(static_cast<double>(histogram.ValueAtPercentile(50.0)), 5000.0, 5000.0 / 32);
+   EXPECT_NEAR(static_cast<double>(histogram.ValueAtPercentile(99.0)), 9900.0, 9900.0 / 32);
+   EXPECT_EQ(histogram.ValueAtPercentile(100.0), 10000u);
+}
+
+// Test: A reader thread can take percentiles while the owner records
+TEST(LatencyHistogramTest, ConcurrentReader) {
+   LatencyHistogram histogram;
+   std::atomic<bool> done{false};
+
+   std::thread reader([&]()
+   {
+      std::uint64_t last = 0;
+      while (!done.load())
+      {
+         const std::uint64_t count = histogram.GetCount();
+         EXPECT_GE(count, last);
+         last = count;
+         (void)histogram.ValueAtPercentile(99.0);
+      }
+   });
+
+   for (std::uint64_t i = 0; i < 200000; ++i)
+      histogram.Record(i % 5000);
+   done.store(true);
+   reader.join();
+
+   EXPECT_EQ(histogram.GetCount(), 200000u);
+}
+
+#ifdef LOB_LATENCY_STATS
+// Test: Book operations are timed by type and outcome
+TEST(LatencyHistogramTest, OrderbookRecordsOperations) {
+   Orderbook book;
+   Order ask(OrderType::GoodTillCancel, 1, 101, Side::Sell, 10);
+   book.ExecuteTrade(ask);
+   Order buy(OrderType::ImmediateOrCancel, 2, 101, Side::Buy, 4);
+   book.ExecuteTrade(buy);
+   book.ModifyOrder(1, 101, 2);
+   book.CancelOrder(1);
+   book.CancelOrder(1);
+
+   const OrderbookLatency& stats = book.GetLatencyStats();
+   EXPECT_EQ(stats.ExecuteTrade(OrderType::GoodTillCancel, OrderOutcome::AddedToOrderbook).GetCount(), 1u);
+   EXPECT_EQ(stats.ExecuteTrade(OrderType::ImmediateOrCancel, OrderOutcome::FullyFilled).GetCount(), 1u);
+   EXPECT_EQ(stats.modifyOrder.GetCount(), 1u);
+   EXPECT_EQ(stats.cancelOrder.GetCount(), 2u);
+
+   std::ostringstream table;
+   stats.WritePercentiles(table);
+   EXPECT_NE(table.str().find("ExecuteTrade ImmediateOrCancel FullyFilled"), std::string::npos);
+   EXPECT_NE(table.str().find("CancelOrder"), std::string::npos);
+}
+#endif
+
+// Test: A buy stop waits, then fires as a market order once a trade reaches it
+TEST(StopOrderTest, BuyStopTriggersAsMarket) {
+   Orderbook book;
+   Order ask1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 5);
+   Order ask2(OrderType::GoodTillCancel, 2, 102, Side::Sell, 10);
+   book.ExecuteTrade(ask1);
+   book.ExecuteTrade(ask2);
+
+   Order stop(OrderType::Stop, 3, 0, Side::Buy, 4, 100);
+   EXPECT_EQ(book.ExecuteTrade(stop), OrderOutcome::AddedToOrderbook);
+   EXPECT_EQ(book.GetPendingStopCount(), 1u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 102), 10);
+
+   // Trades at 100, which releases the stop into the 102 level.
+   Order buy(OrderType::ImmediateOrCancel, 4, 100, Side::Buy, 5);
+   EXPECT_EQ(book.ExecuteTrade(buy), OrderOutcome::FullyFilled);
+
+   EXPECT_EQ(book.GetPendingStopCount(), 0u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 102), 6);
+   EXPECT_EQ(book.GetLastTradePrice(), 102);
+}
+
+// Test: Only crossed stops fire, nearest stop price first and FIFO within a price
+TEST(StopOrderTest, ReleasesCrossedStopsInPriorityOrder) {
+   Orderbook book;
+   for (ID id = 1; id <= 5; ++id)
+   {
+      Order bid(OrderType::GoodTillCancel, id, 100 - static_cast<Price>(id), Side::Buy, 100);
+      book.ExecuteTrade(bid);
+   }
+
+   Order far(OrderType::StopLimit, 10, 90, Side::Sell, 1, 95);
+   Order second(OrderType::StopLimit, 11, 90, Side::Sell, 1, 98);
+   Order first(OrderType::StopLimit, 12, 90, Side::Sell, 1, 99);
+   Order third(OrderType::StopLimit, 13, 90, Side::Sell, 1, 98);
+   for (Order* stop : {&far, &second, &first, &third})
+      book.ExecuteTrade(*stop);
+   book.GetExecutionEvents().Clear();
+
+   Order sell(OrderType::ImmediateOrCancel, 20, 98, Side::Sell, 101);
+   book.ExecuteTrade(sell);
+
+   std::vector<ID> triggered;
+   ExecutionEvent event;
+   while (book.GetExecutionEvents().Pop(event))
+   {
+      if (event.type == ExecutionEventType::Triggered)
+         triggered.push_back(event.orderId);
+   }
+   EXPECT_EQ(triggered, (std::vector<ID>{12, 11, 13}));
+   EXPECT_EQ(book.GetPendingStopCount(), 1u);
+
+   // Each released stop became a sell limit at 90 and traded into the 98 bid.
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 98), 96);
+}
+
+// Test: A stop crossed by an earlier fill of a sweep fires even though
+// the sweep's last fill is back on the other side of it
+TEST(StopOrderTest, SweepReleasesStopsCrossedMidway) {
+   Orderbook book;
+   Order high(OrderType::GoodTillCancel, 1, 110, Side::Sell, 1);
+   Order lift(OrderType::ImmediateOrCancel, 2, 110, Side::Buy, 1);
+   book.ExecuteTrade(high);
+   book.ExecuteTrade(lift);
+   ASSERT_EQ(book.GetLastTradePrice(), 110);
+
+   Order bid(OrderType::GoodTillCancel, 3, 90, Side::Buy, 5);
+   Order ask1(OrderType::GoodTillCancel, 4, 100, Side::Sell, 1);
+   Order ask2(OrderType::GoodTillCancel, 5, 105, Side::Sell, 1);
+   Order stop(OrderType::Stop, 6, 0, Side::Sell, 1, 102);
+   book.ExecuteTrade(bid);
+   book.ExecuteTrade(ask1);
+   book.ExecuteTrade(ask2);
+   EXPECT_EQ(book.ExecuteTrade(stop), OrderOutcome::AddedToOrderbook);
+
+   // Prints 100, then 105: the stop at 102 was crossed by the first fill.
+   Order sweep(OrderType::Market, 7, 0, Side::Buy, 2);
+   EXPECT_EQ(book.ExecuteTrade(sweep), OrderOutcome::FullyFilled);
+
+   EXPECT_EQ(book.GetPendingStopCount(), 0u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 90), 4);
+   EXPECT_EQ(book.GetLastTradePrice(), 90);
+}
+
+// Test: Fills from a released stop can trigger further stops
+TEST(StopOrderTest, TriggersCascade) {
+   Orderbook book;
+   Order ask1(OrderType::GoodTillCancel, 1, 100, Side::Sell, 1);
+   Order ask2(OrderType::GoodTillCancel, 2, 101, Side::Sell, 1);
+   Order ask3(OrderType::GoodTillCancel, 3, 102, Side::Sell, 1);
+   book.ExecuteTrade(ask1);
+   book.ExecuteTrade(ask2);
+   book.ExecuteTrade(ask3);
+
+   Order stopA(OrderType::Stop, 4, 0, Side::Buy, 1, 100);
+   Order stopB(OrderType::Stop, 5, 0, Side::Buy, 1, 101);
+   book.ExecuteTrade(stopA);
+   book.ExecuteTrade(stopB);
+
+   Order buy(OrderType::ImmediateOrCancel, 6, 100, Side::Buy, 1);
+   book.ExecuteTrade(buy);
+
+   EXPECT_EQ(book.GetPendingStopCount(), 0u);
+   EXPECT_EQ(book.GetLastTradePrice(), 102);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Sell, 102), 0u);
+}
+
+// Test: Stops can be cancelled; a stop already crossed fires on entry
+TEST(StopOrderTest, CancelAndImmediateTrigger) {
+   Orderbook book;
+   Order stop(OrderType::StopLimit, 1, 105, Side::Buy, 5, 110);
+   book.ExecuteTrade(stop);
+   EXPECT_TRUE(book.CancelOrder(1));
+   EXPECT_FALSE(book.CancelOrder(1));
+   EXPECT_EQ(book.GetPendingStopCount(), 0u);
+
+   Order ask(OrderType::GoodTillCancel, 2, 100, Side::Sell, 5);
+   Order buy(OrderType::GoodTillCancel, 3, 100, Side::Buy, 2);
+   book.ExecuteTrade(ask);
+   book.ExecuteTrade(buy);
+
+   // Last trade 100 is already below this sell stop, so it rests as a limit.
+   Order sellStop(OrderType::StopLimit, 4, 103, Side::Sell, 7, 101);
+   EXPECT_EQ(book.ExecuteTrade(sellStop), OrderOutcome::AddedToOrderbook);
+   EXPECT_EQ(book.GetPendingStopCount(), 0u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 103), 7);
+}
+
+// Test: Pending stops and the last trade survive a snapshot
+TEST(StopOrderTest, SnapshotKeepsPendingStops) {
+   const std::string path = ::testing::TempDir() + "orderbook_snapshot_stops.bin";
+   Orderbook original;
+   Order ask(OrderType::GoodTillCancel, 1, 100, Side::Sell, 5);
+   Order buy(OrderType::GoodTillCancel, 2, 100, Side::Buy, 1);
+   Order stop(OrderType::Stop, 3, 0, Side::Buy, 2, 101);
+   original.ExecuteTrade(ask);
+   original.ExecuteTrade(buy);
+   original.ExecuteTrade(stop);
+   ASSERT_TRUE(original.SaveSnapshot(path));
+
+   Orderbook loaded;
+   ASSERT_TRUE(loaded.LoadSnapshot(path));
+   EXPECT_EQ(loaded.GetPendingStopCount(), 1u);
+   EXPECT_EQ(loaded.GetLastTradePrice(), 100);
+
+   Order ask2(OrderType::GoodTillCancel, 4, 101, Side::Sell, 5);
+   Order lift(OrderType::GoodTillCancel, 5, 101, Side::Buy, 5);
+   loaded.ExecuteTrade(ask2);
+   loaded.ExecuteTrade(lift);
+   // lift takes 4 at 100 and 1 at 101; the released stop then takes 2 more.
+   EXPECT_EQ(loaded.GetPendingStopCount(), 0u);
+   EXPECT_EQ(loaded.GetVolumeAtPrice(Side::Sell, 101), 2);
+   std::remove(path.c_str());
+}
+
+// Test: CancelAll empties one side with one report per order and one update per level
+TEST(MassCancelTest, CancelAllDropsOneSide) {
+   Orderbook book;
+   for (ID id = 1; id <= 9; ++id)
+   {
+      Order bid(OrderType::GoodTillCancel, id, 95 + static_cast<Price>(id % 3), Side::Buy, 10);
+      book.ExecuteTrade(bid);
+   }
+   Order ask(OrderType::GoodTillCancel, 10, 101, Side::Sell, 4);
+   book.ExecuteTrade(ask);
+   book.GetExecutionEvents().Clear();
+   book.GetLevelUpdates().Clear();
+
+   EXPECT_EQ(book.CancelAll(Side::Buy), 9u);
+   EXPECT_TRUE(book.GetDepth(Side::Buy, 10).empty());
+   EXPECT_FALSE(book.FindOrder(5).has_value());
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 4);
+   EXPECT_EQ(book.GetExecutionEvents().size(), 9u);
+   EXPECT_EQ(book.GetLevelUpdates().size(), 3u);
+   EXPECT_EQ(book.CancelAll(Side::Buy), 0u);
+
+   // The emptied side takes new orders as before.
+   Order bid(OrderType::GoodTillCancel, 11, 90, Side::Buy, 3);
+   book.ExecuteTrade(bid);
+   EXPECT_EQ(book.GetDepth(Side::Buy, 1)[0].price, 90);
+}
+
+// Test: CancelRange drops only the levels inside the inclusive range
+TEST(MassCancelTest, CancelRangeKeepsLevelsOutside) {
+   Orderbook book;
+   for (ID id = 1; id <= 6; ++id)
+   {
+      Order ask(OrderType::GoodTillCancel, id, 100 + static_cast<Price>(id), Side::Sell, static_cast<Volume>(id));
+      book.ExecuteTrade(ask);
+   }
+
+   EXPECT_EQ(book.CancelRange(Side::Sell, 100, 102), 2u);
+   EXPECT_EQ(book.GetDepth(Side::Sell, 1)[0].price, 103);
+   EXPECT_EQ(book.CancelRange(Side::Sell, 104, 105), 2u);
+   EXPECT_EQ(book.CancelRange(Side::Sell, 200, 300), 0u);
+
+   const std::vector<DepthLevel> depth = book.GetDepth(Side::Sell, 10);
+   ASSERT_EQ(depth.size(), 2u);
+   EXPECT_EQ(depth[0].price, 103);
+   EXPECT_EQ(depth[1].price, 106);
+
+   // The worst level goes too when the range reaches it.
+   EXPECT_EQ(book.CancelRange(Side::Sell, 104, 110), 1u);
+   Order lift(OrderType::Market, 7, 0, Side::Buy, 3);
+   EXPECT_EQ(book.ExecuteTrade(lift), OrderOutcome::FullyFilled);
+   EXPECT_TRUE(book.GetDepth(Side::Sell, 10).empty());
+}
+
+// Test: CancelByOwner pulls that owner's resting orders and stops only
+TEST(MassCancelTest, CancelByOwnerLeavesOthers) {
+   Orderbook book;
+   for (ID id = 1; id <= 6; ++id)
+   {
+      Order bid(OrderType::GoodTillCancel, id, 100, Side::Buy, 10);
+      bid.SetOwner((id % 2) ? 7 : 8);
+      book.ExecuteTrade(bid);
+   }
+   Order stop(OrderType::Stop, 7, 0, Side::Sell, 5, 90);
+   stop.SetOwner(7);
+   book.ExecuteTrade(stop);
+   Order lone(OrderType::GoodTillCancel, 9, 98, Side::Buy, 10);
+   lone.SetOwner(7);
+   book.ExecuteTrade(lone);
+
+   book.GetExecutionEvents().Clear();
+   book.GetLevelUpdates().Clear();
+   EXPECT_EQ(book.CancelByOwner(7), 5u);
+   EXPECT_EQ(book.GetOrderCountAtPrice(Side::Buy, 100), 3u);
+   EXPECT_EQ(book.GetPendingStopCount(), 0u);
+   EXPECT_EQ(book.FindOrder(2)->GetOwner(), 8u);
+   EXPECT_EQ(book.GetExecutionEvents().size(), 5u);
+
+   // One depth update per level, with the level as the cancel left it.
+   const RingBuffer<LevelUpdate>& updates = book.GetLevelUpdates();
+   ASSERT_EQ(updates.size(), 2u);
+   EXPECT_EQ(updates[0].price, 98);
+   EXPECT_EQ(updates[0].volume, 0);
+   EXPECT_EQ(updates[1].price, 100);
+   EXPECT_EQ(updates[1].volume, 30);
+   EXPECT_EQ(updates[1].orderCount, 3u);
+   EXPECT_EQ(book.CancelByOwner(7), 0u);
+}
+
+// Test: An owner's open-order count follows adds, fills, cancels and stops
+TEST(MassCancelTest, OpenOrderCountPerOwner) {
+   Orderbook book;
+   for (ID id = 1; id <= 3; ++id)
+   {
+      Order bid(OrderType::GoodTillCancel, id, 100 - static_cast<Price>(id), Side::Buy, 10);
+      bid.SetOwner(5);
+      book.ExecuteTrade(bid);
+   }
+   Order stop(OrderType::StopLimit, 4, 99, Side::Sell, 5, 98);
+   stop.SetOwner(5);
+   book.ExecuteTrade(stop);
+   EXPECT_EQ(book.GetOpenOrderCount(5), 4u);
+   EXPECT_EQ(book.GetOpenOrderCount(6), 0u);
+
+   // Fills 1 at 99 and part of 2 at 98; the released stop rests as an ask at 99.
+   Order sell(OrderType::ImmediateOrCancel, 5, 98, Side::Sell, 15);
+   sell.SetOwner(6);
+   book.ExecuteTrade(sell);
+   EXPECT_EQ(book.GetOpenOrderCount(5), 3u);
+   EXPECT_EQ(book.GetOpenOrderCount(6), 0u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 99), 5);
+
+   book.CancelOrder(3);
+   EXPECT_EQ(book.GetOpenOrderCount(5), 2u);
+   EXPECT_EQ(book.CancelByOwner(5), 2u);
+   EXPECT_EQ(book.GetOpenOrderCount(5), 0u);
+   EXPECT_TRUE(book.GetDepth(Side::Buy, 10).empty());
+}
+
+// Test: Owners survive a snapshot, so a reloaded book can still cancel on disconnect
+TEST(MassCancelTest, SnapshotKeepsOwners) {
+   const std::string path = ::testing::TempDir() + "orderbook_snapshot_owners.bin";
+   Orderbook original;
+   for (ID id = 1; id <= 8; ++id)
+   {
+      Order ask(OrderType::GoodTillCancel, id, 100 + static_cast<Price>(id % 4), Side::Sell, 10);
+      ask.SetOwner(static_cast<OwnerID>(1 + id % 2));
+      original.ExecuteTrade(ask);
+   }
+   ASSERT_TRUE(original.SaveSnapshot(path));
+
+   Orderbook loaded;
+   ASSERT_TRUE(loaded.LoadSnapshot(path));
+   EXPECT_EQ(loaded.GetOpenOrderCount(1), 4u);
+   EXPECT_EQ(loaded.CancelByOwner(2), 4u);
+   EXPECT_EQ(loaded.GetOrderCountAtPrice(Side::Sell, 100), 2u);
+   EXPECT_EQ(loaded.GetOrderCountAtPrice(Side::Sell, 101), 0u);
+   std::remove(path.c_str());
+}
+
+// Test: Mass cancels are journalled once each and replay to the same book
+TEST(MassCancelTest, JournalReplaysMassCancels) {
+   const std::string path = ::testing::TempDir() + "orderbook_journal_mass.bin";
+   Orderbook live;
+   {
+      Journal journal;
+      ASSERT_TRUE(journal.Create(path, 256));
+      live.AttachJournal(&journal);
+
+      for (ID id = 1; id <= 20; ++id)
+      {
+         const Side side = (id % 2) ? Side::Buy : Side::Sell;
+         Order order(OrderType::GoodTillCancel, id, (side == Side::Buy) ? 90 + static_cast<Price>(id % 5)
+                                                                          : 101 + static_cast<Price>(id % 5),
+                     side, 10);
+         order.SetOwner(static_cast<OwnerID>(id % 3));
+         live.ExecuteTrade(order);
+      }
+      live.CancelRange(Side::Sell, 102, 103);
+      live.CancelByOwner(1);
+      live.CancelAll(Side::Buy);
+
+      EXPECT_EQ(journal.GetRecordCount(), 23u);
+      live.AttachJournal(nullptr);
+   }
+
+   Orderbook replayed;
+   EXPECT_EQ(ReplayJournal(path, replayed), 23u);
+   for (Price price = 90; price <= 110; ++price)
+   {
+      EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Buy, price), live.GetVolumeAtPrice(Side::Buy, price));
+      EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Sell, price), live.GetVolumeAtPrice(Side::Sell, price));
+   }
+   std::remove(path.c_str());
+}
+
+// Test: CancelNewest drops the incoming order; CancelOldest drops the resting one and keeps matching
+TEST(SelfTradePreventionTest, CancelNewestAndOldest) {
+   Orderbook book;
+   Order own(OrderType::GoodTillCancel, 1, 100, Side::Sell, 5);
+   Order other(OrderType::GoodTillCancel, 2, 101, Side::Sell, 5);
+   own.SetOwner(1);
+   other.SetOwner(2);
+   book.ExecuteTrade(own);
+   book.ExecuteTrade(other);
+
+   Order newest(OrderType::GoodTillCancel, 3, 101, Side::Buy, 8);
+   newest.SetOwner(1);
+   newest.SetSelfTradePrevention(SelfTradePrevention::CancelNewest);
+   EXPECT_EQ(book.ExecuteTrade(newest), OrderOutcome::Cancelled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 100), 5);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 5);
+   EXPECT_TRUE(book.GetDepth(Side::Buy, 1).empty());
+
+   book.GetExecutionEvents().Clear();
+   Order oldest(OrderType::GoodTillCancel, 4, 101, Side::Buy, 8);
+   oldest.SetOwner(1);
+   oldest.SetSelfTradePrevention(SelfTradePrevention::CancelOldest);
+   EXPECT_EQ(book.ExecuteTrade(oldest), OrderOutcome::PartiallyFilledAndAddedToBook);
+   EXPECT_FALSE(book.FindOrder(1).has_value());
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 101), 3);
+   EXPECT_EQ(book.GetOpenOrderCount(1), 1u);
+
+   std::vector<ExecutionEvent> drained;
+   book.GetExecutionEvents().Drain([&drained](const ExecutionEvent& event) { drained.push_back(event); });
+   ASSERT_EQ(drained.size(), 3u);
+   EXPECT_EQ(drained[1].type, ExecutionEventType::SelfTradePrevented);
+   EXPECT_EQ(drained[1].orderId, 1u);
+   EXPECT_EQ(drained[1].counterpartyId, 4u);
+   EXPECT_EQ(drained[2].type, ExecutionEventType::Fill);
+   EXPECT_EQ(drained[2].orderId, 2u);
+}
+
+// Test: CancelBoth drops both orders; Decrement shrinks both without a trade
+TEST(SelfTradePreventionTest, CancelBothAndDecrement) {
+   Orderbook book;
+   for (ID id = 1; id <= 3; ++id)
+   {
+      Order ask(OrderType::GoodTillCancel, id, 99 + static_cast<Price>(id), Side::Sell, 10);
+      ask.SetOwner(id == 3 ? 2 : 1);
+      book.ExecuteTrade(ask);
+   }
+
+   Order both(OrderType::ImmediateOrCancel, 4, 102, Side::Buy, 4);
+   both.SetOwner(1);
+   both.SetSelfTradePrevention(SelfTradePrevention::CancelBoth);
+   EXPECT_EQ(book.ExecuteTrade(both), OrderOutcome::Cancelled);
+   EXPECT_FALSE(book.FindOrder(1).has_value());
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 10);
+
+   // 4 is decremented away against order 2, which keeps 6 and is not traded.
+   Order small(OrderType::GoodTillCancel, 5, 102, Side::Buy, 4);
+   small.SetOwner(1);
+   small.SetSelfTradePrevention(SelfTradePrevention::Decrement);
+   EXPECT_EQ(book.ExecuteTrade(small), OrderOutcome::Cancelled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 6);
+   EXPECT_EQ(book.GetLastTradePrice(), 0);
+
+   // 6 is decremented against order 2, which leaves; 3 then trades with order 3.
+   Order large(OrderType::Market, 6, 0, Side::Buy, 9);
+   large.SetOwner(1);
+   large.SetSelfTradePrevention(SelfTradePrevention::Decrement);
+   EXPECT_EQ(book.ExecuteTrade(large), OrderOutcome::PartiallyFilledAndCancelled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 0);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 102), 7);
+   EXPECT_EQ(book.GetLastTradePrice(), 102);
+   EXPECT_EQ(book.GetOpenOrderCount(1), 0u);
+}
+
+// Test: Fill-or-Kill only counts volume it could actually trade with
+TEST(SelfTradePreventionTest, FillOrKillSkipsOwnVolume) {
+   Orderbook book;
+   Order own(OrderType::GoodTillCancel, 1, 100, Side::Sell, 5);
+   Order other(OrderType::GoodTillCancel, 2, 101, Side::Sell, 5);
+   own.SetOwner(1);
+   other.SetOwner(2);
+   book.ExecuteTrade(own);
+   book.ExecuteTrade(other);
+
+   Order newest(OrderType::FillOrKill, 3, 101, Side::Buy, 5);
+   newest.SetOwner(1);
+   newest.SetSelfTradePrevention(SelfTradePrevention::CancelNewest);
+   EXPECT_EQ(book.ExecuteTrade(newest), OrderOutcome::Cancelled);
+
+   Order tooLarge(OrderType::FillOrKill, 4, 101, Side::Buy, 6);
+   tooLarge.SetOwner(1);
+   tooLarge.SetSelfTradePrevention(SelfTradePrevention::CancelOldest);
+   EXPECT_EQ(book.ExecuteTrade(tooLarge), OrderOutcome::Cancelled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 100), 5);
+
+   Order fits(OrderType::FillOrKill, 5, 101, Side::Buy, 5);
+   fits.SetOwner(1);
+   fits.SetSelfTradePrevention(SelfTradePrevention::CancelOldest);
+   EXPECT_EQ(book.ExecuteTrade(fits), OrderOutcome::FullyFilled);
+   EXPECT_TRUE(book.GetDepth(Side::Sell, 10).empty());
+}
+
+// Test: Fill-or-Kill checks count the owner's own levels order by order
+// and every other level by its total, ignoring the owner's orders on the
+// same side, beyond the limit or still pending as stops
+TEST(SelfTradePreventionTest, FillOrKillWalksOnlyOwnerLevels) {
+   Orderbook book;
+   Order a(OrderType::GoodTillCancel, 1, 100, Side::Sell, 5);
+   Order b(OrderType::GoodTillCancel, 2, 101, Side::Sell, 5);
+   Order c(OrderType::GoodTillCancel, 3, 101, Side::Sell, 4);
+   Order d(OrderType::GoodTillCancel, 4, 102, Side::Sell, 5);
+   Order e(OrderType::GoodTillCancel, 5, 110, Side::Sell, 5);
+   Order bid(OrderType::GoodTillCancel, 6, 90, Side::Buy, 3);
+   Order stop(OrderType::Stop, 7, 0, Side::Sell, 3, 80);
+   a.SetOwner(2);
+   b.SetOwner(2);
+   d.SetOwner(2);
+   for (Order* own : {&c, &e, &bid, &stop})
+      own->SetOwner(1);
+   for (Order* order : {&a, &b, &c, &d, &e, &bid, &stop})
+      book.ExecuteTrade(*order);
+
+   // Reaches 10 at 101 before the owner's order queued behind b.
+   Order reaches(OrderType::FillOrKill, 10, 102, Side::Buy, 10);
+   reaches.SetOwner(1);
+   reaches.SetSelfTradePrevention(SelfTradePrevention::CancelNewest);
+   EXPECT_EQ(book.ExecuteTrade(reaches), OrderOutcome::FullyFilled);
+
+   Order blocked(OrderType::FillOrKill, 11, 102, Side::Buy, 6);
+   blocked.SetOwner(1);
+   blocked.SetSelfTradePrevention(SelfTradePrevention::CancelNewest);
+   EXPECT_EQ(book.ExecuteTrade(blocked), OrderOutcome::Cancelled);
+
+   Order skips(OrderType::FillOrKill, 12, 102, Side::Buy, 5);
+   skips.SetOwner(1);
+   skips.SetSelfTradePrevention(SelfTradePrevention::CancelOldest);
+   EXPECT_EQ(book.ExecuteTrade(skips), OrderOutcome::FullyFilled);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Sell, 101), 0);
+
+   Order stranger(OrderType::FillOrKill, 13, 110, Side::Buy, 5);
+   stranger.SetOwner(3);
+   stranger.SetSelfTradePrevention(SelfTradePrevention::CancelBoth);
+   EXPECT_EQ(book.ExecuteTrade(stranger), OrderOutcome::FullyFilled);
+   EXPECT_EQ(book.GetOpenOrderCount(1), 2u);
+}
+
+struct TimerNode
+{
+   Timestamp deadline;
+   TimerLink link;
+};
+
+// Test: The timing wheel fires exactly the due nodes, in deadline order, across every level
+TEST(TimingWheelTest, MatchesSortedDeadlines) {
+   std::mt19937_64 random(7);
+   std::vector<TimerNode> nodes(2000);
+   TimingWheel<TimerNode, &TimerNode::link> wheel;
+   auto at = [&nodes](const TimerIndex index) -> TimerNode& { return nodes[index]; };
+   wheel.Reset(1000);
+
+   std::multiset<Timestamp> pending;
+   for (std::size_t i = 0; i < nodes.size(); ++i)
+   {
+      // Mix of near deadlines and ones many levels up.
+      const unsigned span = static_cast<unsigned>(random() % 48) + 1;
+      nodes[i].deadline = 1001 + random() % (Timestamp{1} << span);
+      wheel.Schedule(at, static_cast<TimerIndex>(i), nodes[i].deadline);
+      pending.insert(nodes[i].deadline);
+   }
+   for (std::size_t i = 0; i < nodes.size(); i += 10)
+   {
+      wheel.Cancel(at, static_cast<TimerIndex>(i));
+      wheel.Cancel(at, static_cast<TimerIndex>(i));
+      pending.erase(pending.find(nodes[i].deadline));
+   }
+   EXPECT_EQ(wheel.size(), pending.size());
+
+   Timestamp now = 1000;
+   while (!pending.empty())
+   {
+      now += random() % (Timestamp{1} << (random() % 50));
+      std::vector<Timestamp> fired;
+      wheel.Advance(at, now, [&fired](TimerNode& node) { fired.push_back(node.deadline); });
+
+      std::vector<Timestamp> expected(pending.begin(), pending.upper_bound(now));
+      pending.erase(pending.begin(), pending.upper_bound(now));
+      ASSERT_EQ(fired, expected);
+      EXPECT_EQ(wheel.Now(), now);
+   }
+   EXPECT_TRUE(wheel.empty());
+}
+
+// Test: AdvanceTime expires due GoodTillDate orders with one level update per level
+TEST(ExpiryTest, GoodTillDateExpiresOnAdvance) {
+   Orderbook book;
+   for (ID id = 1; id <= 6; ++id)
+   {
+      Order bid(OrderType::GoodTillDate, id, 100 - static_cast<Price>(id % 2), Side::Buy, 10);
+      bid.SetExpiry(id <= 4 ? 50 : 80);
+      book.ExecuteTrade(bid);
+   }
+   Order gtc(OrderType::GoodTillCancel, 7, 99, Side::Buy, 10);
+   book.ExecuteTrade(gtc);
+
+   Order stale(OrderType::GoodTillDate, 8, 98, Side::Buy, 10);
+   stale.SetExpiry(0);
+   EXPECT_EQ(book.ExecuteTrade(stale), OrderOutcome::Cancelled);
+
+   book.GetExecutionEvents().Clear();
+   book.GetLevelUpdates().Clear();
+   EXPECT_EQ(book.AdvanceTime(49), 0u);
+   EXPECT_EQ(book.AdvanceTime(60), 4u);
+   EXPECT_EQ(book.GetTime(), 60u);
+   EXPECT_FALSE(book.FindOrder(3).has_value());
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 99), 20);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 100), 10);
+   EXPECT_EQ(book.GetExecutionEvents().size(), 4u);
+   EXPECT_EQ(book.GetExecutionEvents()[0].type, ExecutionEventType::Expired);
+   EXPECT_EQ(book.GetLevelUpdates().size(), 2u);
+
+   // A filled or cancelled order leaves the wheel with it.
+   book.CancelOrder(5);
+   Order sell(OrderType::Market, 9, 0, Side::Sell, 10);
+   book.ExecuteTrade(sell);
+   EXPECT_EQ(book.AdvanceTime(1000), 0u);
+   EXPECT_EQ(book.GetVolumeAtPrice(Side::Buy, 99), 10);
+   EXPECT_EQ(book.AdvanceTime(500), 0u);
+   EXPECT_EQ(book.GetTime(), 1000u);
+}
+
+// Test: Day orders expire at the session close and replay from the journal
+TEST(ExpiryTest, DayOrdersExpireAtSessionClose) {
+   const std::string path = ::testing::TempDir() + "orderbook_journal_expiry.bin";
+   Orderbook live;
+   {
+      Journal journal;
+      ASSERT_TRUE(journal.Create(path, 64));
+      live.AttachJournal(&journal);
+
+      Order early(OrderType::Day, 1, 101, Side::Sell, 5);
+      EXPECT_EQ(live.ExecuteTrade(early), OrderOutcome::Cancelled);
+
+      live.SetSessionClose(1000);
+      for (ID id = 2; id <= 5; ++id)
+      {
+         Order ask(OrderType::Day, id, 100 + static_cast<Price>(id), Side::Sell, 5);
+         live.ExecuteTrade(ask);
+      }
+      Order gtd(OrderType::GoodTillDate, 6, 110, Side::Sell, 5);
+      gtd.SetExpiry(2000);
+      live.ExecuteTrade(gtd);
+      EXPECT_EQ(live.FindOrder(3)->GetExpiry(), 1000u);
+
+      EXPECT_EQ(live.AdvanceTime(1000), 4u);
+      live.AttachJournal(nullptr);
+   }
+   EXPECT_TRUE(live.GetDepth(Side::Sell, 10).size() == 1);
+
+   Orderbook replayed;
+   EXPECT_EQ(ReplayJournal(path, replayed), 7u);
+   EXPECT_EQ(replayed.GetTime(), 1000u);
+   EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Sell, 110), 5);
+   EXPECT_EQ(replayed.GetOrderCountAtPrice(Side::Sell, 103), 0u);
+   EXPECT_EQ(replayed.AdvanceTime(2000), 1u);
+   std::remove(path.c_str());
+
+   // A snapshot carries the clock and the pending expiry.
+   ASSERT_TRUE(live.SaveSnapshot(path));
+   Orderbook loaded;
+   ASSERT_TRUE(loaded.LoadSnapshot(path));
+   EXPECT_EQ(loaded.GetTime(), 1000u);
+   EXPECT_EQ(loaded.GetSessionClose(), 1000u);
+   EXPECT_EQ(loaded.AdvanceTime(1999), 0u);
+   EXPECT_EQ(loaded.AdvanceTime(2000), 1u);
+   std::remove(path.c_str());
+}
+
+// Test: Replaying a journal rebuilds the same resting book
+TEST(JournalTest, ReplayRebuildsIdenticalBook) {
+   const std::string path = ::testing::TempDir() + "orderbook_journal.bin";
+   Orderbook live;
+   {
+      Journal journal;
+      ASSERT_TRUE(journal.Create(path, 1024, JournalSync::Group, 16));
+      live.AttachJournal(&journal);
+
+      for (ID id = 1; id <= 60; ++id)
+      {
+         const Side side = (id % 2) ? Side::Buy : Side::Sell;
+         const Price price = (side == Side::Buy) ? 95 + static_cast<Price>(id % 5) : 101 + static_cast<Price>(id % 5);
+         Order order(OrderType::GoodTillCancel, id, price, side, 10 + static_cast<Volume>(id));
+         live.ExecuteTrade(order);
+      }
+      for (ID id = 1; id <= 60; id += 7)
+         live.CancelOrder(id);
+      live.ModifyOrder(4, 103, 5);
+      live.ModifyOrder(6, 0, 0);
+
+      Order sweep(OrderType::ImmediateOrCancel, 100, 102, Side::Buy, 150);
+      live.ExecuteTrade(sweep);
+
+      EXPECT_EQ(journal.GetRecordCount(), 72u);
+      live.AttachJournal(nullptr);
+   }
+
+   Orderbook replayed;
+   EXPECT_EQ(ReplayJournal(path, replayed), 72u);
+
+   for (Price price = 90; price <= 110; ++price)
+   {
+      EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Buy, price), live.GetVolumeAtPrice(Side::Buy, price));
+      EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Sell, price), live.GetVolumeAtPrice(Side::Sell, price));
+      EXPECT_EQ(replayed.GetOrderCountAtPrice(Side::Sell, price), live.GetOrderCountAtPrice(Side::Sell, price));
+   }
+   std::remove(path.c_str());
+}
+
+// Test: Commands a full journal cannot record are rejected before they
+// touch the book, so replay still rebuilds the same book
+TEST(JournalTest, FullJournalRejectsCommands) {
+   const std::string path = ::testing::TempDir() + "orderbook_journal_full.bin";
+   Orderbook live;
+   {
+      Journal journal;
+      ASSERT_TRUE(journal.Create(path, 3));
+      live.AttachJournal(&journal);
+
+      Order first(OrderType::GoodTillCancel, 1, 100, Side::Sell, 10);
+      Order second(OrderType::GoodTillCancel, 2, 99, Side::Buy, 10);
+      EXPECT_EQ(live.ExecuteTrade(first), OrderOutcome::AddedToOrderbook);
+      EXPECT_EQ(live.ExecuteTrade(second), OrderOutcome::AddedToOrderbook);
+      EXPECT_TRUE(live.CancelOrder(2));
+      EXPECT_EQ(journal.GetRecordCount(), 3u);
+      live.GetExecutionEvents().Clear();
+
+      Order crossing(OrderType::GoodTillCancel, 3, 100, Side::Buy, 10);
+      EXPECT_EQ(live.ExecuteTrade(crossing), OrderOutcome::Cancelled);
+      EXPECT_FALSE(live.CancelOrder(1));
+      EXPECT_FALSE(live.ModifyOrder(1, 101, 5));
+      EXPECT_EQ(live.CancelAll(Side::Sell), 0u);
+
+      RingBuffer<ExecutionEvent>& events = live.GetExecutionEvents();
+      ASSERT_EQ(events.size(), 4u);
+      ExecutionEvent event;
+      ASSERT_TRUE(events.Pop(event));
+      EXPECT_EQ(event.type, ExecutionEventType::Rejected);
+      EXPECT_EQ(event.orderId, 3u);
+      while (events.Pop(event))
+         EXPECT_EQ(event.type, ExecutionEventType::Rejected);
+
+      EXPECT_EQ(live.GetVolumeAtPrice(Side::Sell, 100), 10);
+      EXPECT_EQ(journal.GetRecordCount(), 3u);
+      live.AttachJournal(nullptr);
+   }
+
+   Orderbook replayed;
+   EXPECT_EQ(ReplayJournal(path, replayed), 3u);
+   EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Sell, 100), 10);
+   EXPECT_EQ(replayed.GetVolumeAtPrice(Side::Buy, 99), 0);
+   EXPECT_FALSE(replayed.FindOrder(3).has_value());
+   std::remove(path.c_str());
+}
+
+// Test: Reopening a journal continues after the last complete record
+TEST(JournalTest, ReopenStopsAtTornRecord) {
+   const std::string path = ::testing::TempDir() + "orderbook_journal_reopen.bin";
+   {
+      Journal journal;
+      ASSERT_TRUE(journal.Create(path, 8));
+      for (ID id = 1; id <= 3; ++id)
+         EXPECT_TRUE(journal.Append({CommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, id, 0, 0}));
+   }
+   {
+      // Simulate a crash mid-write: a later slot with a stray sequence number.
+      MappedFile file;
+      ASSERT_TRUE(file.OpenReadWrite(path));
+      JournalRecord* records = reinterpret_cast<JournalRecord*>(file.GetData() + 64);
+      records[4].sequence = 5;
+   }
+
+   Journal journal;
+   ASSERT_TRUE(journal.Open(path));
+   EXPECT_EQ(journal.GetRecordCount(), 3u);
+   EXPECT_TRUE(journal.Append({CommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 4, 0, 0}));
+   EXPECT_EQ(journal.GetRecords()[3].orderId, 4u);
+   EXPECT_EQ(journal.GetRecordCount(), 4u);
+
+   for (int i = 0; i < 4; ++i)
+      journal.Append({CommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 9, 0, 0});
+   EXPECT_FALSE(journal.Append({CommandType::Cancel, OrderType::GoodTillCancel, Side::Buy, 9, 0, 0}));
+   journal.Close();
+   std::remove(path.c_str());
+}
+
+// Test: A loaded snapshot keeps levels, FIFO priority and the ID counter
+TEST(SnapshotTest, RoundTripPreservesPriority) {
+   const std::string path = ::testing::TempDir() + "orderbook_snapshot.bin";
+   Orderbook original;
+
+   for (int i = 0; i < 4; ++i)
+   {
+      Order bid(OrderType::GoodTillCancel, original.GetNextOrderId(), 99 - (i % 2), Side::Buy, 10 + i);
+      original.ExecuteTrade(bid);
+      Order ask(OrderType::GoodTillCancel, original.GetNextOrderId(), 5000 + i, Side::Sell, 20);
+      original.ExecuteTrade(ask);
+   }
+   ASSERT_TRUE(original.SaveSnapshot(path));
+
+   Orderbook loaded;
+   std::uint64_t journalPosition = 99;
+   ASSERT_TRUE(loaded.LoadSnapshot(path, &journalPosition));
+   EXPECT_EQ(journalPosition, 0u);
+   EXPECT_EQ(loaded.GetNextOrderId(), 9u);
+
+   EXPECT_EQ(loaded.GetVolumeAtPrice(Side::Buy, 99), 22);
+   EXPECT_EQ(loaded.GetOrderCountAtPrice(Side::Buy, 98), 2u);
+   EXPECT_EQ(loaded.GetVolumeAtPrice(Side::Sell, 5003), 20);
+
+   // Orders 1 and 5 rest at 99 in that order, so a sell fills 1 first.
+   Order sell(OrderType::ImmediateOrCancel, 100, 99, Side::Sell, 15);
+   EXPECT_EQ(loaded.ExecuteTrade(sell), OrderOutcome::FullyFilled);
+
+   auto& events = loaded.GetExecutionEvents();
+   ExecutionEvent event;
+   std::vector<ID> filled;
+   while (events.Pop(event))
+   {
+      if (event.type == ExecutionEventType::Fill || event.type == ExecutionEventType::PartialFill)
+         filled.push_back(event.orderId);
+   }
+   EXPECT_EQ(filled, (std::vector<ID>{1, 5}));
+
+   EXPECT_TRUE(loaded.CancelOrder(8));
+   EXPECT_FALSE(loaded.LoadSnapshot(path));   // book is no longer empty
+
+   Orderbook otherTick(0.01);
+   EXPECT_FALSE(otherTick.LoadSnapshot(path));
+   std::remove(path.c_str());
+}
+
+// Test: Snapshot plus journal tail replay matches the live book
+TEST(SnapshotTest, SnapshotWithJournalTail) {
+   const std::string journalPath = ::testing::TempDir() + "orderbook_snapshot_journal.bin";
+   const std::string snapshotPath = ::testing::TempDir() + "orderbook_snapshot_tail.bin";
+
+   Orderbook live;
+   Journal journal;
+   ASSERT_TRUE(journal.Create(journalPath, 256));
+   live.AttachJournal(&journal);
+
+   for (ID id = 1; id <= 40; ++id)
+   {
+      Order order(OrderType::GoodTillCancel, id, 100 + static_cast<Price>(id % 7) - 3,
+                  (id % 2) ? Side::Buy : Side::Sell, 5);
+      live.ExecuteTrade(order);
+   }
+   ASSERT_TRUE(live.SaveSnapshot(snapshotPath));
+
+   for (ID id = 41; id <= 60; ++id)
+   {
+      Order order(OrderType::GoodTillCancel, id, 100 + static_cast<Price>(id % 5) - 2,
+                  (id % 3) ? Side::Sell : Side::Buy, 3);
+      live.ExecuteTrade(order);
+   }
+   live.CancelOrder(7);
+   live.AttachJournal(nullptr);
+   journal.Close();
+
+   Orderbook restored;
+   std::uint64_t journalPosition = 0;
+   ASSERT_TRUE(restored.LoadSnapshot(snapshotPath, &journalPosition));
+   EXPECT_EQ(journalPosition, 40u);
+   EXPECT_EQ(ReplayJournal(journalPath, restored, journalPosition), 21u);
+
+   for (Price price = 90; price <= 110; ++price)
+   {
+      EXPECT_EQ(restored.GetVolumeAtPrice(Side::Buy, price), live.GetVolumeAtPrice(Side::Buy, price));
+      EXPECT_EQ(restored.GetVolumeAtPrice(Side::Sell, price), live.GetVolumeAtPrice(Side::Sell, price));
+      EXPECT_EQ(restored.GetOrderCountAtPrice(Side::Buy, price), live.GetOrderCountAtPrice(Side::Buy, price));
+   }
+   std::remove(journalPath.c_str());
+   std::remove(snapshotPath.c_str());
+}
+
 int main(int argc, char** argv) {
    ::testing::InitGoogleTest(&argc, argv);
    return RUN_ALL_TESTS();